@@ -0,0 +1,135 @@
+#include "instances.h"
+
+#include <cstdint>
+#include <map>
+#include <random>
+
+// Uniform integer in [low, high]. The standard fixes the mt19937 sequence
+// but not how uniform_int_distribution maps it, which differs between
+// standard libraries, so the mapping is done here.
+static int drawInt(std::mt19937& rng, int low, int high) {
+  return low + static_cast<int>(rng() % static_cast<uint32_t>(high - low + 1));
+}
+
+// Collapse a list of item sizes into demands, one per distinct size
+static std::vector<Demand> toDemands(const std::vector<double>& items) {
+  std::map<double, int, std::greater<double>> counts;
+  for (double item : items) {
+    counts[item]++;
+  }
+  std::vector<Demand> demands;
+  for (const auto& [length, quantity] : counts) {
+    demands.push_back(Demand(length, quantity));
+  }
+  return demands;
+}
+
+static BenchInstance uniformInstance(const std::string& family, size_t items,
+                                     int capacity, int low, int high,
+                                     unsigned seed) {
+  std::mt19937 rng(seed);
+  std::vector<double> sizes(items);
+  for (double& s : sizes) {
+    s = drawInt(rng, low, high);
+  }
+  BenchInstance instance;
+  instance.name = family + "-" + std::to_string(items) + "-c" +
+                  std::to_string(capacity) + "-w" + std::to_string(low) +
+                  "-" + std::to_string(high);
+  instance.family = family;
+  instance.stock = capacity;
+  instance.demands = toDemands(sizes);
+  return instance;
+}
+
+// Falkenauer's triplet class: every bin of the optimum holds one item of
+// [380, 490] and two that fill the rest exactly, each in [250, 500)
+static BenchInstance tripletInstance(size_t triplets, unsigned seed) {
+  const int capacity = 1000;
+  std::mt19937 rng(seed);
+  std::vector<double> sizes;
+  for (size_t t = 0; t < triplets; t++) {
+    int a = drawInt(rng, 380, 490);
+    int rest = capacity - a;
+    int b = drawInt(rng, 250, rest - 251);
+    sizes.push_back(a);
+    sizes.push_back(b);
+    sizes.push_back(rest - b);
+  }
+  BenchInstance instance;
+  instance.name = "falkenauer-t-like-" + std::to_string(sizes.size());
+  instance.family = "falkenauer-t-like";
+  instance.stock = capacity;
+  instance.demands = toDemands(sizes);
+  instance.optimum = static_cast<int>(triplets);
+  return instance;
+}
+
+// Scholl's second set: capacity 1000 and weights around capacity / `per`,
+// spread by `spread` either side
+static BenchInstance schollLargeItems(size_t items, int per, double spread,
+                                      unsigned seed) {
+  const int capacity = 1000;
+  const double mean = static_cast<double>(capacity) / per;
+  std::mt19937 rng(seed);
+  const int low = static_cast<int>(mean * (1 - spread));
+  const int high = static_cast<int>(mean * (1 + spread));
+  std::vector<double> sizes(items);
+  for (double& s : sizes) {
+    s = drawInt(rng, low, high);
+  }
+  BenchInstance instance;
+  instance.name = "scholl-2-like-" + std::to_string(items) + "-w" +
+                  std::to_string(per);
+  instance.family = "scholl-2-like";
+  instance.stock = capacity;
+  instance.demands = toDemands(sizes);
+  return instance;
+}
+
+// A fabrication cut list: distinct lengths between 6" and 10' in 1/16"
+// steps, each wanted a few to a few dozen times
+static BenchInstance shopInstance(size_t lengths, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::map<double, int, std::greater<double>> counts;
+  while (counts.size() < lengths) {
+    double length = drawInt(rng, 6 * 16, 120 * 16) / 16.0;
+    counts[length] = drawInt(rng, 1, 40);
+  }
+  BenchInstance instance;
+  instance.name = "shop-" + std::to_string(lengths);
+  instance.family = "shop";
+  instance.stock = 288;
+  instance.kerf = 0.125;
+  for (const auto& [length, count] : counts) {
+    instance.demands.push_back(Demand(length, count));
+  }
+  return instance;
+}
+
+std::vector<BenchInstance> benchInstances() {
+  std::vector<BenchInstance> instances;
+  for (size_t items : {120, 250, 500, 1000}) {
+    BenchInstance instance = uniformInstance(
+        "falkenauer-u-like", items, 150, 20, 100, 1000 + items);
+    instance.name = "falkenauer-u-like-" + std::to_string(items);
+    instances.push_back(std::move(instance));
+  }
+  for (size_t triplets : {20, 40, 83, 167}) {
+    instances.push_back(tripletInstance(triplets, 2000 + triplets));
+  }
+  instances.push_back(uniformInstance("scholl-1-like", 50, 100, 1, 100, 3001));
+  instances.push_back(
+      uniformInstance("scholl-1-like", 100, 120, 20, 100, 3002));
+  instances.push_back(
+      uniformInstance("scholl-1-like", 200, 150, 30, 100, 3003));
+  instances.push_back(
+      uniformInstance("scholl-1-like", 500, 150, 20, 100, 3004));
+  instances.push_back(schollLargeItems(100, 3, 0.2, 4001));
+  instances.push_back(schollLargeItems(200, 5, 0.5, 4002));
+  instances.push_back(schollLargeItems(500, 9, 0.9, 4003));
+  for (size_t lengths : {10, 40, 120}) {
+    instances.push_back(shopInstance(lengths, 5000 + lengths));
+  }
+  return instances;
+}
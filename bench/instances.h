@@ -0,0 +1,36 @@
+#ifndef BENCH_INSTANCES_H
+#define BENCH_INSTANCES_H
+
+#include "types.h"
+
+#include <string>
+#include <vector>
+
+// One benchmark job: demands on a single stock length
+struct BenchInstance {
+  std::string name;   // unique, e.g. "falkenauer-u-like-250"
+  std::string family; // generator the instance came from
+  double stock{0.0};  // in inches
+  double kerf{0.0};
+  std::vector<Demand> demands;
+  int optimum{0}; // known optimal stick count, 0 when unknown
+};
+
+// The fixed benchmark corpus. Every instance is generated from a fixed
+// seed with mt19937, mapped to ranges by hand rather than through the
+// standard distributions, so the corpus is identical on every machine,
+// standard library and run.
+//
+// The classic families follow the published generators of the standard
+// 1D bin packing sets (the original files are not shipped here), so the
+// names say "like": sizes and capacities match, the exact items do not.
+//   falkenauer-u-like: capacity 150, item sizes uniform in [20, 100]
+//   falkenauer-t-like: capacity 1000, items in [250, 500] drawn as triplets
+//                      that fill a bin exactly, so the optimum is n / 3
+//   scholl-1-like:     capacities 100-150, uniform sizes, classes as bin1
+//   scholl-2-like:     capacity 1000, few large items per bin, as bin2
+//   shop:              steel shop style cut lists on 24' stock with a 1/8"
+//                      kerf, lengths in 1/16" steps and repeated quantities
+std::vector<BenchInstance> benchInstances();
+
+#endif // BENCH_INSTANCES_H
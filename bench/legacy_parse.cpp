@@ -0,0 +1,152 @@
+// The regex-based length parser src/parse.cpp used before the single-pass
+// rewrite, kept verbatim (renamed) so the benchmark has a baseline to beat
+// and to agree with.
+#include "legacy_parse.h"
+
+#include <cctype>
+#include <regex>
+#include <string>
+
+/**
+ * @brief Parses a string representing a fraction (e.g., "1/2") or a decimal
+ * (e.g., "0.5").
+ * @param s The input string.
+ * @return The parsed value as a double. Returns 0.0 on failure.
+ */
+double legacyParseFraction(const std::string& s) {
+  std::string trimmed = std::regex_replace(s, std::regex("^\\s+|\\s+$"), "");
+  if (trimmed.empty())
+    return 0.0;
+
+  // Check for a fraction format like "numerator / denominator"
+  if (trimmed.find('/') != std::string::npos) {
+    std::regex re(R"(\s*(\d+(?:\.\d+)?)\s*\/\s*(\d+(?:\.\d+)?)\s*)");
+    std::smatch matches;
+    if (std::regex_match(trimmed, matches, re)) {
+      try {
+        double num = std::stod(matches[1].str());
+        double den = std::stod(matches[2].str());
+        if (den != 0) {
+          return num / den;
+        }
+      } catch (const std::exception&) {
+        return 0.0;
+      }
+    }
+  } else {
+    // If not a fraction, try to parse as a simple number
+    try {
+      size_t pos;
+      double val = std::stod(trimmed, &pos);
+      // Ensure the whole string was consumed to avoid partial matches
+      if (pos == trimmed.length()) {
+        return val;
+      }
+    } catch (const std::exception&) {
+      return 0.0;
+    }
+  }
+  return 0.0; // Return 0.0 on any parsing failure
+}
+
+/**
+ * @brief Parses various length formats into inches as a double.
+ *
+ * Handles formats like:
+ * - "24'" (24 feet)
+ * - "7'6\"" (7 feet 6 inches)
+ * - "7' 6\"" (7 feet 6 inches with space)
+ * - "7' 6" (7 feet 6 inches without inch mark)
+ * - "7' 6 1/2\"" (7 feet 6.5 inches)
+ * - "7' 6\" 1/2" (alternative format)
+ * - "110 1/8" (110 and 1/8 inches)
+ * - "110.125" (decimal inches)
+ *
+ * @param s The input string.
+ * @return The total length in inches as a double.
+ */
+double legacyParseAdvancedLength(const std::string& s) {
+  std::string input = std::regex_replace(s, std::regex("^\\s+|\\s+$"), "");
+  if (input.empty())
+    return 0.0;
+
+  double total_inches = 0.0;
+
+  // First, check for feet marker (')
+  size_t feet_pos = input.find('\'');
+  if (feet_pos != std::string::npos) {
+    // Parse feet part
+    std::string feet_str = input.substr(0, feet_pos);
+    total_inches += legacyParseFraction(feet_str) * 12.0;
+
+    // Get the remaining string after feet
+    input = input.substr(feet_pos + 1);
+    input = std::regex_replace(input, std::regex("^\\s+|\\s+$"), "");
+  }
+
+  // If nothing left after feet, we're done
+  if (input.empty())
+    return total_inches;
+
+  // Now we need to parse the inches part, which might be in various formats:
+  // - "6\"" (just inches)
+  // - "6\" 1/2" (inches followed by fraction)
+  // - "6 1/2\"" (mixed number with inch mark at end)
+  // - "6 1/2" (mixed number without inch mark)
+  // - "1/2" (just a fraction)
+
+  // Remove any trailing inch mark first to simplify parsing
+  if (!input.empty() && input.back() == '"') {
+    input.pop_back();
+    input = std::regex_replace(input, std::regex("^\\s+|\\s+$"), "");
+  }
+
+  // Check if there's an inch mark in the middle (like "6\" 1/2")
+  size_t inch_mark_pos = input.find('"');
+  if (inch_mark_pos != std::string::npos) {
+    // Parse the part before the inch mark as whole inches
+    std::string before_mark = input.substr(0, inch_mark_pos);
+    total_inches += legacyParseFraction(before_mark);
+
+    // Parse the part after the inch mark as additional fraction
+    std::string after_mark = input.substr(inch_mark_pos + 1);
+    after_mark = std::regex_replace(after_mark, std::regex("^\\s+|\\s+$"), "");
+    if (!after_mark.empty()) {
+      total_inches += legacyParseFraction(after_mark);
+    }
+  } else {
+    // No inch mark in the middle, parse as mixed number or single value
+
+    // Look for a space that might indicate a mixed number (like "6 1/2")
+    // We need to be careful to identify the right space - the one before a
+    // fraction
+    size_t last_space = std::string::npos;
+    for (size_t i = 0; i < input.length(); ++i) {
+      if (std::isspace(input[i])) {
+        // Check if what follows looks like a fraction
+        size_t next_non_space = input.find_first_not_of(" \t", i);
+        if (next_non_space != std::string::npos) {
+          size_t slash_pos = input.find('/', next_non_space);
+          if (slash_pos != std::string::npos) {
+            // This space is before a fraction
+            last_space = i;
+          }
+        }
+      }
+    }
+
+    if (last_space != std::string::npos) {
+      // Parse as mixed number
+      std::string whole_part = input.substr(0, last_space);
+      std::string frac_part = input.substr(last_space + 1);
+
+      total_inches += legacyParseFraction(whole_part);
+      total_inches += legacyParseFraction(frac_part);
+    } else {
+      // Parse as single value (either fraction or decimal)
+      total_inches += legacyParseFraction(input);
+    }
+  }
+
+  return total_inches;
+}
@@ -0,0 +1,10 @@
+#ifndef LEGACY_PARSE_H
+#define LEGACY_PARSE_H
+
+#include <string>
+
+// Regex-based parser this repo shipped before parseLength; 0.0 on failure
+double legacyParseAdvancedLength(const std::string& s);
+double legacyParseFraction(const std::string& s);
+
+#endif // LEGACY_PARSE_H
@@ -0,0 +1,111 @@
+// Length parser benchmark: the single-pass parseLength against the regex
+// parser it replaced, over a generated corpus in every supported format.
+//
+//   make bench && ./bin/parse-bench [lines] [rounds]
+
+#include "legacy_parse.h"
+#include "parse.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Lines in the shapes a cut list import sees, from a fixed seed
+static std::vector<std::string> makeCorpus(size_t lines) {
+  std::mt19937 rng(12345);
+  std::uniform_int_distribution<int> feet(1, 24);
+  std::uniform_int_distribution<int> inches(0, 11);
+  std::uniform_int_distribution<int> sixteenths(1, 15);
+  std::uniform_int_distribution<int> shape(0, 7);
+
+  std::vector<std::string> corpus;
+  corpus.reserve(lines);
+  for (size_t i = 0; i < lines; i++) {
+    std::string f = std::to_string(feet(rng));
+    std::string in = std::to_string(inches(rng));
+    std::string frac = std::to_string(sixteenths(rng)) + "/16";
+    switch (shape(rng)) {
+    case 0:
+      corpus.push_back(f + "'");
+      break;
+    case 1:
+      corpus.push_back(f + "'" + in + "\"");
+      break;
+    case 2:
+      corpus.push_back(f + "' " + in + " " + frac + "\"");
+      break;
+    case 3:
+      corpus.push_back(f + "' " + in + "\" " + frac);
+      break;
+    case 4:
+      corpus.push_back(std::to_string(feet(rng) * 12) + " " + frac);
+      break;
+    case 5:
+      corpus.push_back(std::to_string(feet(rng) * 12) + ".125");
+      break;
+    case 6:
+      corpus.push_back("  " + in + " \"");
+      break;
+    default:
+      corpus.push_back(frac);
+      break;
+    }
+  }
+  return corpus;
+}
+
+template <typename Parse>
+static double timeParser(const std::vector<std::string>& corpus, int rounds,
+                         Parse parse, double& checksum) {
+  auto start = std::chrono::steady_clock::now();
+  checksum = 0.0;
+  for (int r = 0; r < rounds; r++) {
+    for (const auto& line : corpus) {
+      checksum += parse(line);
+    }
+  }
+  std::chrono::duration<double, std::nano> taken =
+      std::chrono::steady_clock::now() - start;
+  return taken.count() / (static_cast<double>(corpus.size()) * rounds);
+}
+
+int main(int argc, char* argv[]) {
+  size_t lines = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+  std::vector<std::string> corpus = makeCorpus(lines);
+
+  // Both parsers must agree before their speed means anything
+  size_t mismatches = 0;
+  std::string error;
+  for (const auto& line : corpus) {
+    double value = 0.0;
+    if (!parseLength(line, value, error) ||
+        std::abs(value - legacyParseAdvancedLength(line)) > 1e-9) {
+      if (mismatches++ < 5)
+        std::cerr << "mismatch: \"" << line << "\" " << error << std::endl;
+    }
+  }
+
+  double legacySum, newSum;
+  double legacyNs =
+      timeParser(corpus, rounds, legacyParseAdvancedLength, legacySum);
+  double newNs = timeParser(
+      corpus, rounds,
+      [&error](const std::string& line) {
+        double value = 0.0;
+        parseLength(line, value, error);
+        return value;
+      },
+      newSum);
+
+  std::cout << "lines: " << corpus.size() << " x " << rounds << " rounds\n"
+            << "legacy regex parser: " << legacyNs << " ns/line\n"
+            << "parseLength:         " << newNs << " ns/line\n"
+            << "speedup:             " << legacyNs / newNs << "x\n"
+            << "mismatches:          " << mismatches << std::endl;
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+// Optimizer benchmark over the fixed instance corpus (bench/instances.h).
+// Prints one JSON line per instance: pattern enumeration, the whole
+// optimizeCutting run with its phases split out (HiGHS on its own), then
+// grouping, serialization and length parsing on the result.
+//
+//   make bench && ./bin/solver-bench [--filter NAME] [--time-limit MS]
+//       [--mode exhaustive|column_generation] [--baseline FILE]
+//       [--tolerance RATIO] > results.jsonl
+//
+// With --baseline, the run is compared against an earlier output: more
+// sticks, a different pattern count, or time or memory beyond the tolerance
+// (default 1.5x, ignoring differences under a noise floor) are reported on
+// stderr and make the exit status 1.
+
+#include "algorithm.h"
+#include "instances.h"
+#include "json.hpp"
+#include "json_writer.h"
+#include "output.h"
+#include "parse.h"
+#include "patterns.h"
+#include "report.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+static double millisSince(Clock::time_point start) {
+  std::chrono::duration<double, std::milli> taken = Clock::now() - start;
+  return taken.count();
+}
+
+// Peak resident set size of the process so far, in KiB
+static long peakRssKb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+// Time `rounds` calls of `work`, in microseconds per call
+template <typename Work>
+static double microsPerCall(int rounds, Work work) {
+  auto start = Clock::now();
+  for (int r = 0; r < rounds; r++) {
+    work();
+  }
+  return millisSince(start) * 1000.0 / rounds;
+}
+
+static json runInstance(const BenchInstance& instance,
+                        const SolverOptions& options) {
+  long rssBefore = peakRssKb();
+  std::vector<long long> lengths;
+  long long items = 0;
+  for (const auto& demand : instance.demands) {
+    lengths.push_back(std::llround(demand.length * PRECISION_SCALE));
+    items += demand.quantity;
+  }
+  long long scaledStock = std::llround(instance.stock * PRECISION_SCALE);
+  long long scaledKerf = std::llround(instance.kerf * PRECISION_SCALE);
+
+  json row;
+  row["instance"] = instance.name;
+  row["family"] = instance.family;
+  row["items"] = items;
+  row["lengths"] = lengths.size();
+  row["stock"] = instance.stock;
+
+  // Enumeration alone, uncached, within the solver's own budget
+  auto start = Clock::now();
+  PatternSet patterns =
+      generatePatterns(lengths, scaledStock, scaledKerf, false,
+                       options.patternBudget, options.enumerationThreads);
+  row["pattern_ms"] = millisSince(start);
+  row["patterns"] = patterns.size();
+  row["patterns_truncated"] = patterns.truncated;
+  row["pattern_bytes"] = patterns.start.size() * sizeof(HighsInt) +
+                         patterns.index.size() * sizeof(HighsInt) +
+                         patterns.value.size() * sizeof(double);
+  patterns = PatternSet();
+
+  std::vector<StockType> stock = {StockType(instance.stock)};
+  start = Clock::now();
+  Solution solution =
+      optimizeCutting(instance.demands, stock, instance.kerf, options);
+  row["solve_ms"] = millisSince(start);
+  row["sticks"] = solution.num_sticks;
+  row["optimum"] = instance.optimum;
+  row["status"] = solution.status;
+  row["gap"] = solution.mip_gap;
+  row["heuristic_ms"] = solution.stats.heuristic_ms;
+  row["solve_pattern_ms"] = solution.stats.pattern_ms;
+  row["model_ms"] = solution.stats.model_ms;
+  row["mip_ms"] = solution.stats.mip_ms;
+  row["columns"] = solution.stats.columns;
+  row["mip_nodes"] = solution.stats.mip_nodes;
+  row["lp_iterations"] = solution.stats.lp_iterations;
+
+  const int rounds = 200;
+  size_t groups = 0;
+  row["group_us"] = microsPerCall(
+      rounds, [&] { groups = groupPatterns(solution).size(); });
+  row["groups"] = groups;
+  std::string text;
+  row["json_us"] = microsPerCall(rounds, [&] {
+    text.clear();
+    JsonWriter out(text);
+    SolutionWriter(solution, stock).write(out);
+  });
+  row["json_bytes"] = text.size();
+
+  // The parser on the instance's own lengths, as a client would send them
+  std::vector<std::string> pretty;
+  for (const auto& demand : instance.demands) {
+    pretty.push_back(prettyLen(demand.length));
+  }
+  double checksum = 0.0;
+  double parseUs = microsPerCall(rounds, [&] {
+    for (const auto& length : pretty) {
+      checksum += parseAdvancedLength(length);
+    }
+  });
+  row["parse_ns"] = parseUs * 1000.0 / std::max<size_t>(1, pretty.size());
+  row["rss_growth_kb"] = peakRssKb() - rssBefore;
+  return row;
+}
+
+// Compare a result with its baseline row; false (with messages) on a
+// regression
+static bool compareRow(const json& row, const json& base, double tolerance) {
+  bool ok = true;
+  const std::string name = row["instance"];
+  auto fail = [&](const std::string& what) {
+    std::cerr << name << ": " << what << std::endl;
+    ok = false;
+  };
+  if (!row["patterns_truncated"].get<bool>() &&
+      !base["patterns_truncated"].get<bool>() &&
+      row["patterns"] != base["patterns"]) {
+    fail("pattern count " + row["patterns"].dump() + " != baseline " +
+         base["patterns"].dump());
+  }
+  if (row["sticks"].get<int>() > base["sticks"].get<int>()) {
+    fail("sticks " + row["sticks"].dump() + " > baseline " +
+         base["sticks"].dump());
+  }
+  // Times below the floor are mostly noise
+  auto slower = [&](const char* field, double floor) {
+    double now = row[field].get<double>();
+    double then = base[field].get<double>();
+    if (now > then * tolerance && now - then > floor) {
+      fail(std::string(field) + " " + std::to_string(now) + " vs baseline " +
+           std::to_string(then));
+    }
+  };
+  slower("solve_ms", 50.0);
+  slower("pattern_ms", 20.0);
+  slower("group_us", 20.0);
+  slower("json_us", 50.0);
+  slower("pattern_bytes", 1 << 16);
+  slower("rss_growth_kb", 4096);
+  return ok;
+}
+
+int main(int argc, char* argv[]) {
+  SolverOptions options;
+  options.timeLimitMs = 30000;
+  std::string filter, baselinePath;
+  double tolerance = 1.5;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--filter" && hasValue) {
+      filter = argv[++i];
+    } else if (arg == "--time-limit" && hasValue) {
+      options.timeLimitMs = std::atof(argv[++i]);
+    } else if (arg == "--mode" && hasValue) {
+      std::string mode = argv[++i];
+      options.mode = mode == "column_generation" ? SolverMode::ColumnGeneration
+                                                 : SolverMode::Exhaustive;
+    } else if (arg == "--baseline" && hasValue) {
+      baselinePath = argv[++i];
+    } else if (arg == "--tolerance" && hasValue) {
+      tolerance = std::atof(argv[++i]);
+    } else {
+      std::cerr << "usage: solver-bench [--filter NAME] [--time-limit MS] "
+                   "[--mode exhaustive|column_generation] [--baseline FILE] "
+                   "[--tolerance RATIO]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  std::map<std::string, json> baseline;
+  if (!baselinePath.empty()) {
+    std::ifstream in(baselinePath);
+    if (!in) {
+      std::cerr << "Cannot open " << baselinePath << std::endl;
+      return 1;
+    }
+    for (std::string line; std::getline(in, line);) {
+      if (line.empty())
+        continue;
+      json row = json::parse(line);
+      baseline[row["instance"].get<std::string>()] = row;
+    }
+  }
+
+  bool ok = true;
+  for (const BenchInstance& instance : benchInstances()) {
+    if (!filter.empty() && instance.name.find(filter) == std::string::npos)
+      continue;
+    json row = runInstance(instance, options);
+    std::cout << row.dump() << std::endl;
+    auto base = baseline.find(instance.name);
+    if (base != baseline.end() && !compareRow(row, base->second, tolerance)) {
+      ok = false;
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -1,12 +1,111 @@
 #ifndef ALGORITHM_H
 #define ALGORITHM_H
 
+#include "cache.h"
+#include "patterns.h"
 #include "types.h"
 
+#include <functional>
+#include <memory>
 #include <vector>
 
-// Main optimization function using HiGHS
+// How the set of cutting patterns for the MIP is built
+enum class SolverMode {
+  // Enumerate every feasible pattern up front (exact, can blow up)
+  Exhaustive,
+  // Gilmore-Gomory column generation: price new patterns from LP duals
+  ColumnGeneration,
+};
+
+// How hard optimizeCutting works for the answer
+enum class SolveQuality {
+  // Proven optimum from the MIP (warm started from the heuristics)
+  Optimal,
+  // Best of First-Fit and Best-Fit Decreasing, no MIP at all
+  Fast,
+};
+
+// Snapshot of a running solve, reported through SolverOptions::onProgress
+struct SolveProgress {
+  double elapsedMs{0.0};
+  double objective{0.0}; // cost of the best plan so far
+  double bound{0.0};     // best proven lower bound on the cost
+  double gap{0.0};       // relative gap between the two
+  // The new best plan when the report is for an improvement, else null
+  std::shared_ptr<const Solution> incumbent;
+};
+
+// Tuning knobs for optimizeCutting
+struct SolverOptions {
+  SolverMode mode{SolverMode::Exhaustive};
+  SolveQuality quality{SolveQuality::Optimal};
+  // Upper bound on pricing rounds in column generation mode
+  int maxPricingRounds{1000};
+  // Enumerate only maximal patterns and cover demand with >= rows; surplus
+  // pieces are trimmed and reported in Solution::surplus_pieces
+  bool maximalPatterns{false};
+  // Wall-clock limit for the whole solve, 0 for none. When it is hit the
+  // best incumbent found so far is returned.
+  double timeLimitMs{0.0};
+  // Relative MIP gap at which HiGHS stops (HiGHS's own default)
+  double mipGap{1e-4};
+  // Limits on exhaustive enumeration; a truncated set falls back to column
+  // generation
+  PatternBudget patternBudget;
+  // Threads to enumerate patterns with; the set is identical for any count
+  unsigned enumerationThreads{1};
+  // Shortest leftover (in inches) reported in Solution::offcuts, 0 for none
+  double offcutThreshold{0.0};
+  // Units the job was given in, which set the integer grid it is solved on
+  // (see unitScale); lengths passed in and out are inches either way
+  LengthUnits units{LengthUnits::Inches};
+  // Called on the solving thread whenever the best plan improves and, at
+  // most every few hundred milliseconds, with the current bound. Keep it
+  // quick; it holds up the solver.
+  std::function<void(const SolveProgress&)> onProgress;
+};
+
+// Remnant pieces on hand as a stock type, priced far below any new stock in
+// `stock` per unit of length so the solver consumes them first
+StockType remnantStock(double length, int count,
+                       const std::vector<StockType>& stock);
+
+// Canonical signature of a job: the sorted (scaled length, quantity)
+// multiset, scaled stock length and kerf, and the options that change the
+// result. Cut ids, labels, job name and material are deliberately left out,
+// so a list of Demands and the same pieces as Cuts share a signature.
+JobSignature makeJobSignature(const std::vector<Demand>& demands,
+                              const std::vector<StockType>& stock, double kerf,
+                              const SolverOptions& options);
+JobSignature makeJobSignature(const std::vector<Cut>& cuts,
+                              const std::vector<StockType>& stock, double kerf,
+                              const SolverOptions& options);
+JobSignature makeJobSignature(const std::vector<Cut>& cuts, double stockLen,
+                              double kerf, const SolverOptions& options);
+
+// A solved exhaustive model, kept so that a job which only changes the
+// quantities of the same lengths re-solves it instead of building anew
+struct CachedModel;
+
+// Hit/miss counters of the solved model cache
+LruCache<JobSignature, std::shared_ptr<CachedModel>, JobSignatureHash>::Stats
+modelCacheStats();
+
+// Main optimization function using HiGHS. Chooses the cheapest mix of the
+// given stock types in one MIP; each run records the stock it came from.
+// Work and memory grow with the distinct lengths, not with the quantities;
+// the pieces of demand entry k carry id k when the sticks are expanded.
+Solution optimizeCutting(const std::vector<Demand>& demands,
+                         const std::vector<StockType>& stock, double kerf,
+                         const SolverOptions& options = {});
+
+// The same for one Cut per piece, which keeps its own id
+Solution optimizeCutting(const std::vector<Cut>& cuts,
+                         const std::vector<StockType>& stock, double kerf,
+                         const SolverOptions& options = {});
+
+// Single stock length at unit cost: minimizes the number of sticks
 Solution optimizeCutting(const std::vector<Cut>& cuts, double stockLen,
-                         double kerf);
+                         double kerf, const SolverOptions& options = {});
 
 #endif // ALGORITHM_H
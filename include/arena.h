@@ -0,0 +1,38 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+// Scratch memory for the short-lived containers of one solve: sticks being
+// packed, demand tables, grouping keys. Each thread has its own monotonic
+// arena, so these allocations take no lock and are never freed one by one;
+// the whole arena is reset when the outermost ScratchScope on the thread
+// ends. The arena keeps its first block across resets and grows it to what
+// earlier requests needed, so a busy worker thread settles into serving a
+// request entirely from memory it already holds.
+//
+// Containers on scratch() must not outlive the scope they were made in, and
+// nothing that goes into a Solution or a cache may use it.
+class ScratchScope {
+public:
+  ScratchScope();
+  ~ScratchScope();
+  ScratchScope(const ScratchScope&) = delete;
+  ScratchScope& operator=(const ScratchScope&) = delete;
+};
+
+// The calling thread's arena inside a ScratchScope, the ordinary heap
+// outside one
+std::pmr::memory_resource* scratch();
+
+struct ScratchStats {
+  size_t reservedBytes; // first blocks kept over all threads
+  uint64_t resets;      // outermost scopes ended
+  uint64_t overflows;   // resets that had outgrown the first block
+};
+
+ScratchStats scratchStats();
+
+#endif // ARENA_H
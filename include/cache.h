@@ -0,0 +1,123 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Canonical, order-independent description of a request. Two requests with
+// equal signatures produce the same result, so it is used as a cache key.
+struct JobSignature {
+  std::vector<long long> words;
+  size_t hash{0};
+
+  bool operator==(const JobSignature& other) const {
+    return hash == other.hash && words == other.words;
+  }
+};
+
+struct JobSignatureHash {
+  size_t operator()(const JobSignature& signature) const {
+    return signature.hash;
+  }
+};
+
+// Mix a sequence of 64-bit words into a hash (splitmix64 finalizer per word)
+inline size_t hashWords(const long long* words, size_t count) {
+  uint64_t h = 0x9e3779b97f4a7c15ULL;
+  for (size_t i = 0; i < count; i++) {
+    uint64_t x = static_cast<uint64_t>(words[i]) + 0x9e3779b97f4a7c15ULL + h;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    h = x ^ (x >> 31);
+  }
+  return static_cast<size_t>(h);
+}
+
+inline size_t hashWords(const std::vector<long long>& words) {
+  return hashWords(words.data(), words.size());
+}
+
+// Thread-safe least-recently-used cache with a time-to-live per entry.
+// Values should be cheap to copy (e.g. shared_ptr), since get() copies under
+// the lock.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    size_t size;
+    size_t capacity;
+  };
+
+  LruCache(size_t capacity, double ttlSeconds)
+      : capacity_(capacity),
+        ttl_(std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(ttlSeconds))) {}
+
+  // Look up a key, refreshing its recency. Expired entries count as misses.
+  bool get(const Key& key, Value& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      if (Clock::now() - it->second->stored <= ttl_) {
+        entries_.splice(entries_.begin(), entries_, it->second);
+        value = it->second->value;
+        hits_++;
+        return true;
+      }
+      entries_.erase(it->second);
+      index_.erase(it);
+    }
+    misses_++;
+    return false;
+  }
+
+  void put(const Key& key, Value value) {
+    if (capacity_ == 0)
+      return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      entries_.erase(it->second);
+      index_.erase(it);
+    }
+    entries_.push_front({key, std::move(value), Clock::now()});
+    index_[key] = entries_.begin();
+    while (entries_.size() > capacity_) {
+      index_.erase(entries_.back().key);
+      entries_.pop_back();
+    }
+  }
+
+  Stats stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {hits_.load(), misses_.load(), entries_.size(), capacity_};
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Entry {
+    Key key;
+    Value value;
+    Clock::time_point stored;
+  };
+
+  const size_t capacity_;
+  const Clock::duration ttl_;
+  mutable std::mutex mutex_;
+  std::list<Entry> entries_; // most recently used first
+  std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
+
+#endif // CACHE_H
@@ -0,0 +1,74 @@
+#ifndef CUT_LIST_H
+#define CUT_LIST_H
+
+#include "types.h"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// One distinct cut of a cut list with its total quantity
+struct CutListItem {
+  double length{0.0};   // in inches
+  long long scaled{0};  // length in unitScale units
+  long long quantity{0};
+  std::string label;    // label or part number column, if any
+};
+
+// Streaming reader for CSV / TSV cut lists. Chunks of the body are fed in as
+// they arrive and each complete line is parsed on the spot into aggregates
+// keyed on (scaled length, label), so neither the raw text nor one entry per
+// piece is ever held.
+//
+// The delimiter (tab, comma or semicolon) is taken from the first line. When
+// that line's first field is not a length it is read as a header naming the
+// length, quantity and label columns; otherwise the columns are length,
+// quantity (default 1) and label in that order. Fields may be quoted, with
+// "" for a literal quote, so exported inch marks survive. Lengths are read
+// in the job's units and kept in inches. A line over 4 KiB fails, so a body
+// without newlines is never buffered whole.
+class CutListReader {
+public:
+  explicit CutListReader(LengthUnits units = LengthUnits::Inches)
+      : units_(units) {}
+
+  // Parse the next chunk; false once a line has failed
+  bool feed(std::string_view chunk);
+  // Parse a final line without a newline; false if any line failed
+  bool finish();
+
+  // Why reading failed, with the line number
+  const std::string& error() const { return error_; }
+  // Distinct cuts in order of first appearance
+  const std::vector<CutListItem>& items() const { return items_; }
+  // Lines read, header and blank lines included
+  size_t lines() const { return lineNumber_; }
+
+private:
+  bool parseLine(std::string_view line);
+  bool readHeader(const std::vector<std::string_view>& fields);
+  bool fail(const std::string& what);
+  bool failLongLine();
+  std::string_view unquote(std::string_view field, std::string& scratch);
+
+  LengthUnits units_;
+  std::string partial_;  // an incomplete line carried over between chunks
+  std::string error_;
+  size_t lineNumber_{0};
+  bool sawFirstLine_{false};
+  char delimiter_{','};
+  int lengthColumn_{0};
+  int quantityColumn_{1};
+  int labelColumn_{2};
+
+  std::vector<CutListItem> items_;
+  std::unordered_map<std::string, size_t> itemIndex_;
+
+  // Reused between lines so steady-state parsing does not allocate
+  std::vector<std::string_view> fields_;
+  std::vector<std::string> scratch_;
+  std::string key_;
+};
+
+#endif // CUT_LIST_H
@@ -0,0 +1,56 @@
+#ifndef HEURISTICS_H
+#define HEURISTICS_H
+
+#include "patterns.h"
+
+#include <vector>
+
+// A stock length in scaled units, as the packers see it
+struct StockOption {
+  long long length{0};
+  double cost{1.0};
+  int available{-1}; // -1 for unlimited
+  bool remnant{false};
+};
+
+// A complete packing: the distinct stick layouts it uses, how many sticks
+// are cut with each layout and which stock type they are cut from
+struct Packing {
+  PatternSet patterns;
+  std::vector<int> multiplicity; // one entry per pattern
+  std::vector<int> stock;        // stock type index per pattern
+
+  int numSticks() const;
+  double cost(const std::vector<StockOption>& stockTypes) const;
+};
+
+// Greedy packings over unique scaled lengths (descending) and their demand.
+// First-Fit puts each piece on the first stick it fits, Best-Fit on the stick
+// it leaves the least room on.
+Packing firstFitDecreasing(const std::vector<long long>& lengths,
+                           const std::vector<int>& demand, long long stockLen,
+                           long long kerf);
+Packing bestFitDecreasing(const std::vector<long long>& lengths,
+                          const std::vector<int>& demand, long long stockLen,
+                          long long kerf);
+
+// Move each stick of a single-length packing onto the cheapest stock type it
+// fits on that still has sticks available, longest layouts first. Returns an
+// empty packing when the availability caps cannot be met this way.
+Packing assignStock(const Packing& packing, long long kerf,
+                    const std::vector<StockOption>& stockTypes);
+
+// Fill the remnants on hand, shortest first, each with the longest pieces
+// that still fit. `demand` is reduced by the pieces placed; the packing holds
+// only remnant sticks.
+Packing fillRemnants(const std::vector<long long>& lengths,
+                     std::vector<int>& demand, long long kerf,
+                     const std::vector<StockOption>& stockTypes);
+
+// Continuous lower bound on the number of sticks: total length over stock
+// length, rounded up, with kerfs accounted the same way as the enumerator
+long long stickLowerBound(const std::vector<long long>& lengths,
+                          const std::vector<int>& demand, long long stockLen,
+                          long long kerf);
+
+#endif // HEURISTICS_H
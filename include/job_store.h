@@ -0,0 +1,102 @@
+#ifndef JOB_STORE_H
+#define JOB_STORE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Lifecycle of an asynchronous job
+enum class JobState { Queued, Running, Done, Failed };
+
+const char* jobStateName(JobState state);
+
+// One message for streaming clients; `data` is a serialized JSON document
+struct JobEvent {
+  uint64_t seq;
+  std::string type;
+  std::string data;
+};
+
+// Status, progress and result of one asynchronous job. Written by the solver
+// thread, read by any number of polling and streaming HTTP threads.
+class JobRecord {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Snapshot {
+    JobState state;
+    std::string progress; // latest "progress" event data, empty before one
+    std::string result;   // final response or error document
+  };
+
+  explicit JobRecord(std::string id) : id_(std::move(id)) {}
+
+  const std::string& id() const { return id_; }
+
+  void setRunning();
+
+  // Publish an event; only the most recent ones are kept for late joiners
+  void publish(const std::string& type, std::string data);
+
+  // Move to Done or Failed with its document, published as a last
+  // "done"/"failed" event
+  void finish(JobState state, std::string result);
+
+  Snapshot snapshot() const;
+
+  bool finished() const;
+
+  // When the job finished, or the epoch if it has not
+  Clock::time_point finishedAt() const;
+
+  // Events after `afterSeq`, waiting up to `timeout` for one to arrive.
+  // `complete` is set once the job has finished and nothing else will come.
+  std::vector<JobEvent> waitEvents(uint64_t afterSeq,
+                                   std::chrono::milliseconds timeout,
+                                   bool& complete) const;
+
+private:
+  static constexpr size_t kMaxEvents = 32;
+
+  const std::string id_;
+  mutable std::mutex mutex_;
+  mutable std::condition_variable changed_;
+  JobState state_{JobState::Queued};
+  std::string progress_;
+  std::string result_;
+  std::deque<JobEvent> events_;
+  uint64_t nextSeq_{1};
+  Clock::time_point finishedAt_{};
+};
+
+// Registry of asynchronous jobs by id. Finished jobs are forgotten after a
+// time-to-live, or earlier when room is needed; new jobs are refused only
+// when `maxJobs` jobs are all still unfinished.
+class JobStore {
+public:
+  JobStore(size_t maxJobs, double ttlSeconds);
+
+  // A new queued job with a fresh random id, or nullptr when full
+  std::shared_ptr<JobRecord> create();
+
+  std::shared_ptr<JobRecord> find(const std::string& id);
+
+private:
+  void prune();
+
+  const size_t maxJobs_;
+  const JobRecord::Clock::duration ttl_;
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<JobRecord>> jobs_;
+  std::mt19937_64 random_;
+};
+
+#endif // JOB_STORE_H
@@ -0,0 +1,59 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Appends compact JSON text straight to a string, with no document tree in
+// between. The caller supplies the structure (begin/end, keys, values) and
+// the writer places the commas and colons and escapes strings. Numbers come
+// out as nlohmann::json dumps them: shortest round-trip digits, with ".0"
+// on integral doubles and null for NaN and infinities.
+//
+// The string may be cleared between calls, e.g. after each chunk of a
+// streamed response has been sent; the writer only keeps the nesting.
+class JsonWriter {
+public:
+  explicit JsonWriter(std::string& out) : out_(out) {}
+
+  void beginObject();
+  void endObject();
+  void beginArray();
+  void endArray();
+  void key(std::string_view name);
+
+  void value(std::string_view text);
+  void value(const char* text) { value(std::string_view(text)); }
+  void value(const std::string& text) { value(std::string_view(text)); }
+  void value(double number);
+  void value(long long number);
+  void value(int number) { value(static_cast<long long>(number)); }
+  void value(size_t number);
+  void value(bool flag);
+  void null();
+  // A value that is already serialized JSON, copied as is
+  void raw(std::string_view json);
+
+  template <typename T> void field(std::string_view name, const T& v) {
+    key(name);
+    value(v);
+  }
+
+  std::string& buffer() { return out_; }
+
+  // `text` as a quoted JSON string, for fragments built ahead of time
+  static void appendString(std::string& out, std::string_view text);
+  static void appendNumber(std::string& out, double number);
+
+private:
+  // Comma before a value in a container that already holds one
+  void separate();
+
+  std::string& out_;
+  std::vector<bool> nonEmpty_; // per open container
+  bool afterKey_{false};
+};
+
+#endif // JSON_WRITER_H
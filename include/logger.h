@@ -0,0 +1,44 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// JSON-lines logger for the server. Once started, request threads only
+// move a record into a bounded lock-free ring; a background thread formats
+// the records and writes them to stdout in batches. When the ring is full
+// the record is dropped and counted rather than making the caller wait, and
+// the writer reports how many went missing. Before start() (and after
+// stop()) records are written synchronously.
+//
+// Records below the level threshold return before anything is formatted,
+// so callers that build a message should check enabled() first.
+class Logger {
+public:
+  enum Level { DEBUG, INFO, WARN, ERROR };
+
+  static std::string levelToString(Level level);
+  // Level for a name like "debug" or "WARN"; false when it is none
+  static bool parseLevel(const std::string& name, Level& level);
+
+  static void setLevel(Level level);
+  static bool enabled(Level level);
+
+  static void log(Level level, std::string message);
+  static void logRequest(const std::string& method, const std::string& path,
+                         int status, const std::string& remoteAddr,
+                         const std::string& remotePort,
+                         double duration_ms = -1);
+
+  // Start the writer thread with room for `capacity` pending records
+  // (rounded up to a power of two)
+  static void start(size_t capacity);
+  // Write out what is queued and join the writer thread
+  static void stop();
+
+  // Records lost to a full ring since start
+  static uint64_t dropped();
+};
+
+#endif // LOGGER_H
@@ -0,0 +1,90 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "types.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Distribution of observed values in fixed buckets, Prometheus style.
+// Observing only touches relaxed atomics, so it never blocks a request; a
+// snapshot taken while others observe may be off by the values in flight.
+class Histogram {
+public:
+  // Upper bounds of the buckets, ascending; a +Inf bucket is added
+  explicit Histogram(std::vector<double> bounds);
+
+  Histogram(const Histogram&) = delete;
+  Histogram& operator=(const Histogram&) = delete;
+
+  void observe(double value);
+
+  // Append the _bucket, _sum and _count samples in the text exposition
+  // format. `labels` is either empty or a list like `phase="mip"`.
+  void write(std::string& out, const std::string& name,
+             const std::string& labels) const;
+
+private:
+  const std::vector<double> bounds_;
+  std::unique_ptr<std::atomic<uint64_t>[]> counts_; // per bucket, plus +Inf
+  std::atomic<double> sum_{0.0};
+};
+
+// `count` bucket bounds from `start`, each `factor` times the last
+std::vector<double> exponentialBuckets(double start, double factor,
+                                       size_t count);
+
+// Steps of handling an optimize request that are timed separately
+enum class Phase {
+  JsonParse,   // request body to a JSON document
+  LengthParse, // lengths and settings out of the document
+  Heuristics,  // bounds and greedy packings
+  Patterns,    // enumeration or column generation
+  ModelBuild,  // MIP matrix and warm start
+  MipSolve,    // HiGHS
+  Grouping,    // runs to patterns for the response
+  Sequencing,  // patterns onto the saws, when asked for
+  Serialize,   // response document to text
+};
+constexpr size_t kNumPhases = 9;
+
+// Name of a phase as it appears in the `phase` label
+const char* phaseName(Phase phase);
+
+// Request and solver histograms served at /api/metrics
+class RequestMetrics {
+public:
+  RequestMetrics();
+
+  void observePhase(Phase phase, double seconds);
+  // The solver phases and MIP size of one finished solve
+  void observeSolve(const Solution& solution);
+  // Wall time of a whole request, answered from the cache or not
+  void observeRequest(double seconds);
+
+  // Append every histogram with its HELP and TYPE lines
+  void write(std::string& out) const;
+
+private:
+  std::array<std::unique_ptr<Histogram>, kNumPhases> phases_;
+  Histogram requestSeconds_;
+  Histogram columns_;
+  Histogram nodes_;
+  Histogram iterations_;
+  Histogram gap_;
+};
+
+// Append a "# HELP" and "# TYPE" header for a metric
+void writeMetricHeader(std::string& out, const std::string& name,
+                       const std::string& type, const std::string& help);
+
+// Append one sample line, "name{labels} value"
+void writeSample(std::string& out, const std::string& name,
+                 const std::string& labels, double value);
+
+#endif // METRICS_H
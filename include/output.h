@@ -6,9 +6,35 @@
 #include <string>
 #include <vector>
 
-// Group sticks into patterns for cleaner output.
+// The runs of one distinct cutting pattern: the first of them, which
+// stands for the layout, and the sticks cut to it over all of them
+struct RunGroup {
+  size_t run{0}; // index into Solution::runs
+  int count{0};
+};
+
+// Group a solution's runs by layout, most-used first, then fullest first,
+// without materializing their cuts
+std::vector<RunGroup> groupRuns(const Solution& solution);
+
+// Group a solution's runs into patterns for cleaner output.
 // This function is used by web_server.cpp to prepare data for the API response.
-std::vector<Pattern> groupPatterns(const std::vector<Stick>& sticks);
+std::vector<Pattern> groupPatterns(const Solution& solution);
+
+// Expand a solution's runs into one Stick per physical stick, handing out
+// the cut ids in `ids` (one set of runs per length, as in Solution::cut_ids)
+// in run order. Only for callers that need per-stick detail; the runs hold
+// the same plan in far less memory.
+std::vector<Stick> expandSticks(const Solution& solution,
+                                const std::vector<IdRuns>& ids);
+// The same with the ids of the request the solution was solved for
+std::vector<Stick> expandSticks(const Solution& solution);
+
+// Id runs of a list of demands over a solution's lengths, laid out as
+// Solution::cut_ids is: for a cached or shared solution, whose own ids are
+// those of whichever identical job was solved first
+std::vector<IdRuns> demandIds(const Solution& solution,
+                              const std::vector<Demand>& demands);
 
 // Convert a decimal to a fraction string for display.
 // This function is used by web_server.cpp to prepare data for the API response.
@@ -1,15 +1,40 @@
 #ifndef PARSE_H
 #define PARSE_H
 
+#include "types.h"
+
 #include <string>
+#include <string_view>
 
 // Parse various length formats (e.g., "24'", "8'4\"", "180 1/2", "288")
-double parseAdvancedLength(const std::string& s);
+// into inches. Returns false with the reason in `error` when the text is not
+// a length.
+bool parseLength(std::string_view s, double& inches, std::string& error);
 
-// Parse a fraction or decimal (e.g., "1/2", "0.125", "3/16")
+// Parse a fraction or decimal (e.g., "1/2", "0.125", "3/16") the same way
+bool parseFraction(std::string_view s, double& value, std::string& error);
+
+// As above, throwing std::invalid_argument with the reason on bad input
+double parseAdvancedLength(const std::string& s);
 double parseFraction(const std::string& s);
 
 // Format inches as feet and inches (e.g., 100.5 -> "8' 4 1/2\"")
 std::string prettyLen(double inches);
 
+// Parse a length in a job's units into inches: any of the formats above
+// for inches, or a decimal number of millimetres with an optional "mm"
+bool parseLength(std::string_view s, LengthUnits units, double& inches,
+                 std::string& error);
+
+// Express inches in a job's units, for output
+double toUnits(double inches, LengthUnits units);
+
+// Format inches for display in a job's units: feet and inches, or
+// millimetres to a tenth (e.g., 2440 -> "2440 mm")
+std::string prettyLen(double inches, LengthUnits units);
+
+// Units by their request name, "in" or "mm"; false for any other
+bool parseUnits(std::string_view name, LengthUnits& units);
+const char* unitsName(LengthUnits units);
+
 #endif // PARSE_H
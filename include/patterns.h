@@ -0,0 +1,55 @@
+#ifndef PATTERNS_H
+#define PATTERNS_H
+
+#include "cache.h"
+#include "util/HighsInt.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Cutting patterns over a table of unique lengths, stored column-wise in the
+// compressed sparse layout HiGHS uses for its constraint matrix. Pattern p
+// holds value[k] pieces of lengths[index[k]] for k in [start[p], start[p+1]).
+struct PatternSet {
+  std::vector<long long> lengths; // unique scaled lengths, descending
+  std::vector<HighsInt> start{0};
+  std::vector<HighsInt> index; // ascending within each pattern
+  std::vector<double> value;
+  bool truncated{false}; // enumeration stopped on a budget
+
+  size_t size() const { return start.size() - 1; }
+};
+
+// Limits that keep a huge or hostile request from exhausting the server
+struct PatternBudget {
+  size_t maxPatterns{500000};
+  double maxMillis{10000.0};
+};
+
+// Enumerate every pattern of the given unique scaled lengths that fits on one
+// stock piece, with one kerf between neighbouring pieces. With `maximalOnly`
+// only patterns with no room left for another piece are emitted. The column
+// order is the same for any number of `threads`, unless a budget truncates
+// the set.
+PatternSet generatePatterns(const std::vector<long long>& uniqueLengths,
+                            long long stockLen, long long kerf,
+                            bool maximalOnly = false,
+                            const PatternBudget& budget = {},
+                            unsigned threads = 1);
+
+// Memoized generatePatterns. Patterns depend only on the lengths, stock and
+// kerf, not on quantities, so jobs that only change counts share one set.
+// Sets cut short by a budget, or too big to keep (over 16 MiB), are
+// returned but not kept.
+std::shared_ptr<const PatternSet>
+cachedPatterns(const std::vector<long long>& uniqueLengths, long long stockLen,
+               long long kerf, bool maximalOnly = false,
+               const PatternBudget& budget = {}, unsigned threads = 1);
+
+// Hit/miss counters of the pattern set cache
+LruCache<JobSignature, std::shared_ptr<const PatternSet>,
+         JobSignatureHash>::Stats
+patternCacheStats();
+
+#endif // PATTERNS_H
@@ -0,0 +1,66 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include "json_writer.h"
+#include "output.h"
+#include "sequence.h"
+#include "types.h"
+
+#include <string>
+#include <vector>
+
+// Writes a Solution as the JSON object the API and the CLI return: totals,
+// stock usage, offcuts and the grouped patterns. The patterns can be written
+// a batch at a time, so a large plan streams out without ever being held as
+// a document:
+//
+//   SolutionWriter writer(solution, stock);
+//   writer.begin(out);
+//   while (writer.next(out, 256)) { /* send and clear the buffer */ }
+//   writer.end(out);
+//
+// Lengths are written in the job's units. The writer refers to the
+// solution and stock, which must outlive it.
+class SolutionWriter {
+public:
+  // Groups the patterns and serializes each distinct cut once
+  SolutionWriter(const Solution& solution, const std::vector<StockType>& stock,
+                 LengthUnits units = LengthUnits::Inches);
+
+  size_t patterns() const { return groups_.size(); }
+  // Roughly the bytes write() produces, for reserving the buffer
+  size_t sizeHint() const;
+
+  // Everything up to the patterns, leaving their array open
+  void begin(JsonWriter& out) const;
+  // Up to `maxPatterns` more patterns; false once all are written
+  bool next(JsonWriter& out, size_t maxPatterns);
+  // Close the patterns and the solution object
+  void end(JsonWriter& out) const;
+  // The whole solution object
+  void write(JsonWriter& out);
+
+private:
+  const Solution& solution_;
+  const std::vector<StockType>& stock_;
+  LengthUnits units_;
+  std::vector<RunGroup> groups_;
+  std::vector<std::string> cuts_;        // one cut object per length index
+  std::vector<std::string> stockPretty_; // per stock type
+  size_t written_{0};                    // patterns written so far
+};
+
+// Write a saw plan as the `sawPlan` object: totals, then each saw's time,
+// setups, open stacks and batches in cutting order
+void writeSawPlan(JsonWriter& out, const SawPlan& plan);
+
+// Write every stick of a solution as the `sticks` array, in the order of
+// its runs: the stock it is cut from, then each cut's length and `entry`,
+// the position in the request's cut list of the line the piece is for.
+// `ids` are the solution's id runs (see demandIds), which index `entries`.
+void writeSticks(JsonWriter& out, const Solution& solution,
+                 const std::vector<IdRuns>& ids,
+                 const std::vector<int>& entries,
+                 LengthUnits units = LengthUnits::Inches);
+
+#endif // REPORT_H
@@ -0,0 +1,72 @@
+#ifndef REQUEST_H
+#define REQUEST_H
+
+#include "algorithm.h"
+#include "json.hpp"
+#include "patterns.h"
+#include "sequence.h"
+#include "types.h"
+
+#include <string>
+#include <vector>
+
+// A validated optimization job: the /api/optimize body after parsing, or
+// a cut list file with its settings
+struct OptimizeRequest {
+  std::string jobName;
+  std::string materialType;
+  std::string modeStr;
+  std::string qualityStr;
+  std::vector<StockType> stock;
+  double stockLen{0.0}; // longest stock on hand
+  double kerf{0.125};
+  std::vector<Demand> demands;
+  long long pieces{0}; // total quantity over all demands
+  int listed{0};       // cut list entries read, skipped ones included
+  std::vector<int> entries; // cut list position of each demand
+  bool sticks{false};       // list every stick with its cuts' entries
+  SolverOptions options;
+  SawSettings saws; // sequencing on the saws, off unless asked for
+  double maxQueueMs{0.0};
+};
+
+// Limits the operator sets and a request cannot raise
+struct RequestLimits {
+  PatternBudget patternBudget;
+  // Threads each exhaustive enumeration may use
+  unsigned enumerationThreads{1};
+  // Ceiling on the per-request solve time limit (ms), 0 for none
+  double maxTimeLimitMs{0.0};
+  // Longest a request may wait for a free solver (ms), 0 for no limit
+  double maxQueueMs{30000.0};
+  // Ceiling on the saw sequencing search per request (ms)
+  double maxSequenceMs{2000.0};
+};
+
+// Parse one length field of a request, given in `units`, into inches.
+// Returns false with a message naming the field in `error` when its text is
+// not a length.
+bool readLength(const std::string& text, LengthUnits units,
+                const std::string& field, double& inches, std::string& error);
+
+// Parse and validate everything about a request but its cuts: stock, kerf
+// and solver options. Returns false with the message for a 400 response in
+// `error` when they are unusable.
+bool parseSolveSettings(const nlohmann::json& body,
+                        const RequestLimits& limits, OptimizeRequest& request,
+                        std::string& error);
+
+// Add `quantity` cuts of one length to a request, the next entry of its cut
+// list. Non-positive entries are skipped; a cut longer than all the stock,
+// or one past the pieces a request listing its sticks may have, fails with
+// the message in `error`.
+bool addCuts(OptimizeRequest& request, double length, long long quantity,
+             const std::string& label, std::string& error);
+
+// Parse and validate an optimization request. Returns false with the message
+// for a 400 response in `error` when the body is unusable.
+bool parseOptimizeRequest(const nlohmann::json& body,
+                          const RequestLimits& limits,
+                          OptimizeRequest& request, std::string& error);
+
+#endif // REQUEST_H
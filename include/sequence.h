@@ -0,0 +1,56 @@
+#ifndef SEQUENCE_H
+#define SEQUENCE_H
+
+#include "types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// How the saws on the floor work, for sequencing a plan on them. A saw has
+// one length stop per distinct cut length of the pattern it is cutting;
+// going on to a pattern moves the stops for the lengths the last one did
+// not have. Each length has its own part stack at the saw, open from its
+// first piece to its last.
+struct SawSettings {
+  int saws{0};            // saws to share the plan between, 0 for none
+  int maxOpenStacks{0};   // part stacks a saw may have open, 0 for no limit
+  double stickSeconds{20.0}; // loading a stick and clearing its offcut
+  double cutSeconds{8.0};    // one cut
+  double setupSeconds{45.0}; // moving one stop
+  double timeBudgetMs{200.0}; // for the local search
+  unsigned threads{1};        // searches run side by side
+};
+
+// Consecutive sticks cut to one pattern on one saw. Patterns are numbered
+// as in the solution's `patterns` array (groupRuns order).
+struct SawBatch {
+  size_t pattern{0};
+  int sticks{0};
+};
+
+// One saw's share of the plan, in cutting order
+struct SawSchedule {
+  std::vector<SawBatch> batches;
+  double seconds{0.0}; // cutting and setup time
+  int setups{0};       // stops moved, counting the first pattern's
+  int openStacks{0};   // most part stacks open at once
+};
+
+struct SawPlan {
+  std::vector<SawSchedule> saws;
+  double makespan{0.0};    // seconds until the last saw is done
+  int setups{0};           // over all saws
+  int openStacks{0};       // most on any one saw
+  long long evaluated{0};  // candidate sequences scored
+};
+
+// Order the patterns of a solution on the saws and split their sticks
+// between them: a balanced, low-setup greedy start, improved by a local
+// search on `threads` threads until the time budget is spent or it stops
+// finding better plans. Ranked by open stacks over the limit, then the time
+// the last saw finishes, then total saw time. With a budget the result can
+// vary between runs, but it is never worse than the greedy start.
+SawPlan planSaws(const Solution& solution, const SawSettings& settings);
+
+#endif // SEQUENCE_H
@@ -0,0 +1,94 @@
+#ifndef SOLVER_POOL_H
+#define SOLVER_POOL_H
+
+#include "types.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Thrown from a job's future when it waited in the queue past its limit and
+// was dropped without running
+struct QueueTimeout : std::runtime_error {
+  QueueTimeout() : std::runtime_error("Timed out waiting for a solver") {}
+};
+
+// Fixed set of solver threads fed from a bounded queue, so heavy jobs never
+// run on (or exhaust) the HTTP connection threads. Submission fails fast
+// when the queue is full instead of letting requests pile up.
+class SolverPool {
+public:
+  struct Stats {
+    size_t threads;
+    size_t capacity; // queued jobs allowed on top of the running ones
+    size_t queued;
+    size_t running;
+    uint64_t accepted;
+    uint64_t rejected;
+    uint64_t expired;
+  };
+
+  SolverPool(size_t threads, size_t maxQueued);
+  ~SolverPool();
+
+  SolverPool(const SolverPool&) = delete;
+  SolverPool& operator=(const SolverPool&) = delete;
+
+  // Queue a solve and return its ticket, or 0 when the queue is full or the
+  // pool is stopping. A job still queued after `maxWaitMs` (0 for no limit)
+  // is dropped and its future throws QueueTimeout.
+  uint64_t submit(std::function<Solution()> solve, double maxWaitMs,
+                  std::future<Solution>& result);
+
+  // Take a job that has not started yet off the queue. Returns false when it
+  // is already running or finished, in which case its future still resolves.
+  bool withdraw(uint64_t ticket);
+
+  // Seconds a rejected client should wait before retrying, estimated from
+  // recent solve times and the current backlog
+  int retryAfterSeconds() const;
+
+  Stats stats() const;
+
+  // Finish running jobs, fail the queued ones and join the threads
+  void shutdown();
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Job {
+    uint64_t ticket{0};
+    std::function<Solution()> solve;
+    std::promise<Solution> result;
+    Clock::time_point expires;
+  };
+
+  void workerLoop();
+
+  const size_t maxQueued_;
+  std::vector<std::thread> workers_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<Job> queue_;
+  bool stopping_{false};
+  size_t running_{0};
+  uint64_t nextTicket_{1};
+
+  // Exponential moving average of solve times, for Retry-After
+  std::atomic<double> averageSolveMs_{1000.0};
+  std::atomic<uint64_t> accepted_{0};
+  std::atomic<uint64_t> rejected_{0};
+  std::atomic<uint64_t> expired_{0};
+};
+
+#endif // SOLVER_POOL_H
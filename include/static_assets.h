@@ -0,0 +1,56 @@
+#ifndef STATIC_ASSETS_H
+#define STATIC_ASSETS_H
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One file ready to serve: its bytes, a gzip copy when that is smaller, and
+// the headers that go with it
+struct StaticAsset {
+  std::string body;
+  std::string gzipped; // empty when the type does not compress
+  std::string contentType;
+  std::string etag; // quoted, from a hash of the body
+  // For hot reload: what the file looked like when it was read
+  std::filesystem::file_time_type modified{};
+  uintmax_t size{0};
+};
+
+// Web assets loaded once from the first of a list of root directories that
+// exists, keyed by path relative to that root ("index.html",
+// "favicon.png"). Entries are immutable and shared, so lookups only take a
+// lock for the map itself.
+//
+// With hot reload on, every lookup checks the file on disk and re-reads it
+// when its size or modification time changed, and files added after start
+// are picked up; meant for development.
+class StaticAssets {
+public:
+  StaticAssets(const std::vector<std::string>& roots, bool hotReload);
+
+  // The asset at a relative path, or null when there is none. Paths that
+  // leave the root are never served.
+  std::shared_ptr<const StaticAsset> find(const std::string& path);
+
+  // Directory the assets were loaded from, empty when none was found
+  const std::string& root() const { return root_; }
+  size_t size() const;
+
+  // MIME type for a file name, by extension
+  static std::string contentTypeFor(const std::string& path);
+
+private:
+  std::shared_ptr<const StaticAsset> load(const std::string& path) const;
+
+  std::string root_;
+  bool hotReload_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<const StaticAsset>> assets_;
+};
+
+#endif // STATIC_ASSETS_H
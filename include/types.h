@@ -1,8 +1,31 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <string>
+#include <utility>
 #include <vector>
 
+// Use a scaling factor to convert doubles to integers for the MIP solver,
+// avoiding floating-point precision issues. A power of 2 like 1024 (2^10)
+// is good for handling binary fractions like 1/16, 1/32, etc.
+const int PRECISION_SCALE = 1024;
+
+const double MM_PER_INCH = 25.4;
+
+// Units a job's lengths are given and reported in. Internally lengths stay
+// in inches; the units only pick the integer grid they are solved on.
+enum class LengthUnits {
+  Inches,
+  Millimetres,
+};
+
+// Integer solver units per inch: PRECISION_SCALE for imperial jobs, and
+// 1/64 mm for metric ones, so whole and fractional millimetres land exactly
+// on the grid instead of being rounded to 1/1024"
+inline double unitScale(LengthUnits units) {
+  return units == LengthUnits::Millimetres ? MM_PER_INCH * 64 : PRECISION_SCALE;
+}
+
 // Cut represents a single cut piece
 struct Cut {
   double length{0.0}; // in inches
@@ -12,27 +35,102 @@ struct Cut {
   Cut(double len, int id_) : length(len), id(id_) {}
 };
 
+// Demand is one line of a cut list: a length and how many pieces of it
+struct Demand {
+  double length{0.0}; // in inches
+  int quantity{0};
+  std::string label;  // free text carried through to the output
+
+  Demand() = default;
+  Demand(double len, int quantity_, std::string label_ = "")
+      : length(len), quantity(quantity_), label(std::move(label_)) {}
+};
+
+// (id, pieces) runs naming the request entries a length's pieces came from:
+// cut ids for a list of Cuts, indices for a list of Demands
+using IdRuns = std::vector<std::pair<int, int>>;
+
+// StockType is one stock length the optimizer may cut from
+struct StockType {
+  double length{0.0}; // in inches
+  double cost{1.0};   // per stick
+  int available{-1};  // sticks on hand, -1 for unlimited
+  bool remnant{false}; // an offcut left over from earlier jobs
+
+  StockType() = default;
+  StockType(double len, double cost_ = 1.0, int available_ = -1,
+            bool remnant_ = false)
+      : length(len), cost(cost_), available(available_), remnant(remnant_) {}
+};
+
 // Stick represents a stock piece with its cuts
 struct Stick {
   std::vector<Cut> cuts;
   double stock_len{0.0}; // in inches
   double used_len{0.0};  // in inches
   double waste_len{0.0}; // in inches
+  bool remnant{false};   // cut from a remnant rather than new stock
+};
+
+// StickRun is one cut layout and the number of sticks cut with it. Pieces
+// are (length index, quantity) pairs into Solution::lengths, longest first,
+// so a run costs the same whether it covers one stick or thousands.
+struct StickRun {
+  std::vector<std::pair<int, int>> pieces;
+  int count{0};
+  int stock_type{0};     // index into the job's stock types
+  double stock_len{0.0}; // in inches
+  double used_len{0.0};  // in inches, with the kerfs between pieces
+  double waste_len{0.0}; // in inches
+  bool remnant{false};   // cut from a remnant rather than new stock
+};
+
+// Where a solve spent its time and how big the MIP got. Times are in
+// milliseconds and add up over the parts of a decomposed job.
+struct SolveStats {
+  double heuristic_ms{0.0}; // bounds and greedy packings
+  double pattern_ms{0.0};   // enumeration or column generation
+  double model_ms{0.0};     // laying out the matrix and passing the model
+  double mip_ms{0.0};       // HiGHS run, including the warm start
+  long long columns{0};     // patterns in the MIP
+  long long mip_nodes{0};
+  long long lp_iterations{0};
 };
 
 // Solution represents a cutting solution
 struct Solution {
-  std::vector<Stick> sticks;
+  // Distinct cut lengths in scaled integer units (`scale` per inch),
+  // longest first
+  std::vector<long long> lengths;
+  double scale{1.0};
+  // Request entries each length's pieces came from, handed out to the
+  // pieces in run order
+  std::vector<IdRuns> cut_ids;
+  std::vector<StickRun> runs;
   double total_waste{0.0}; // in inches
   int num_sticks{0};
+  int surplus_pieces{0}; // extra pieces a covering master produced, trimmed
+  double total_cost{0.0}; // sum of stock costs over all sticks
+  std::vector<int> stock_used; // sticks cut from each stock type, in order
+  // Leftovers of at least the offcut threshold, longest first, after the
+  // kerf that separates them from the last piece
+  std::vector<double> offcuts;
+  // "optimal" when proven, "feasible" for an incumbent from a solve that
+  // stopped early, "heuristic" for an unproven greedy packing
+  std::string status;
+  double mip_gap{0.0};         // relative gap between cost and bound
+  double objective_bound{0.0}; // proven lower bound on the total cost
+  SolveStats stats;
 };
 
 // Pattern for grouping identical cutting patterns
 struct Pattern {
   std::vector<Cut> cuts;
   int count{0};
+  double stock_len{0.0};
   double used_len{0.0};
   double waste_len{0.0};
+  bool remnant{false};
 };
 
 #endif // TYPES_H
@@ -12,6 +12,7 @@ pkgs.mkShell {
 
     # Dependencies
     highs
+    zlib
 
     # Development tools
     clang-tools  # Provides clang-format, clang-tidy, clangd (LSP)
@@ -1,211 +1,1525 @@
 #include "algorithm.h"
+#include "arena.h"
+#include "heuristics.h"
 
 #include <Highs.h>
 #include <algorithm>
+#include <chrono>
 #include <cmath>
-#include <functional>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 #include <vector>
 
-// Use a scaling factor to convert doubles to integers for the MIP solver,
-// avoiding floating-point precision issues. A power of 2 like 1024 (2^10)
-// is good for handling binary fractions like 1/16, 1/32, etc.
-const int PRECISION_SCALE = 1024;
+// Remnants are priced at this fraction of the cheapest new stock per unit of
+// length, so they are always consumed first and shorter ones are preferred
+const double REMNANT_COST_FACTOR = 0.01;
 
-// Forward declaration for the internal pattern generation function
-static std::vector<std::vector<long long>>
-generatePatterns(const std::vector<long long>& availableCuts,
-                 long long stockLen, long long kerf);
+// Least time between two progress reports that carry no new plan
+const double PROGRESS_INTERVAL_MS = 250.0;
+
+// Tolerance used when comparing LP duals and reduced costs
+const double PRICING_EPS = 1e-9;
+
+// Solved models are kept for the next job over the same lengths and stock.
+// Each holds a full copy of its pattern matrix, so only a few are kept.
+const size_t MODEL_CACHE_ENTRIES = 4;
+const double MODEL_CACHE_TTL_S = 600;
+
+// An exhaustive model kept after its solve. A later job over the same
+// lengths, stock and kerf differs only in the demand row bounds, so it
+// changes those and re-solves, starting from this job's plan adapted to
+// its own quantities.
+struct CachedModel {
+  std::mutex mutex; // held for the whole of a solve on the model
+  Highs highs;
+  std::vector<int> columnStock; // stock type of each column
+  // Enumerated columns; those after them are the warm start columns of
+  // the last solve, replaced on the next
+  size_t baseColumns{0};
+  std::vector<int> demand; // of the last solve
+  Packing plan;            // its plan, over the demand rows only
+  double bound{0.0};       // proven lower bound on its cost
+};
+
+using ModelCache =
+    LruCache<JobSignature, std::shared_ptr<CachedModel>, JobSignatureHash>;
+
+static ModelCache& modelCache() {
+  static ModelCache cache(MODEL_CACHE_ENTRIES, MODEL_CACHE_TTL_S);
+  return cache;
+}
+
+ModelCache::Stats modelCacheStats() { return modelCache().stats(); }
+
+// Forward declarations for the internal helpers
+static Solution solveDemand(std::vector<long long> uniqueCutKeys,
+                            std::vector<int> demand,
+                            std::vector<IdRuns> cutIds,
+                            const std::vector<StockType>& stock, double kerf,
+                            const SolverOptions& options);
+
+static std::vector<PatternSet>
+generateColumns(const std::vector<long long>& cutLengths,
+                const std::vector<int>& demand,
+                const std::vector<StockOption>& stock, long long kerf,
+                const Packing& seed, int maxRounds,
+                std::chrono::steady_clock::time_point deadline);
+
+static Solution buildSolution(const std::vector<long long>& cutLengths,
+                              const std::vector<IdRuns>& cutIds,
+                              const std::vector<int>& demand,
+                              bool coverDemand,
+                              const std::vector<HighsInt>& start,
+                              const std::vector<HighsInt>& index,
+                              const std::vector<double>& value,
+                              const std::vector<double>& colValue,
+                              const std::vector<int>& columnStock,
+                              const std::vector<StockType>& stock,
+                              double kerf, double scale,
+                              double offcutThreshold);
+
+// Append columns [first, last) of one pattern set (over the same lengths) to
+// another. A non-negative `extraRow` adds a 1 in that row to every column,
+// which is how a column is tied to its stock type's availability row.
+static void appendPatterns(PatternSet& into, const PatternSet& from,
+                           size_t first, size_t last, HighsInt extraRow) {
+  for (size_t p = first; p < last; p++) {
+    for (HighsInt k = from.start[p]; k < from.start[p + 1]; k++) {
+      into.index.push_back(from.index[k]);
+      into.value.push_back(from.value[k]);
+    }
+    if (extraRow >= 0) {
+      into.index.push_back(extraRow);
+      into.value.push_back(1.0);
+    }
+    into.start.push_back(into.index.size());
+  }
+}
+
+// Mark a solution with its proof status given the best known bound
+static void setSolveStatus(Solution& solution, double bound, bool proven) {
+  solution.objective_bound = bound;
+  solution.mip_gap =
+      solution.total_cost > 0
+          ? std::max(0.0, (solution.total_cost - bound) / solution.total_cost)
+          : 0.0;
+  if (proven || solution.mip_gap <= 1e-9) {
+    solution.status = "optimal";
+  }
+}
+
+// Bit pattern of a double, so option values can go into a signature
+static long long doubleBits(double value) {
+  long long bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// Add a separately solved part of the job to a solution of the rest. The
+// parts share no sticks, so costs, bounds and usage simply add up; only the
+// length tables need merging, and the part's runs are renumbered onto it.
+static Solution mergeSolutions(const Solution& part, Solution rest) {
+  std::vector<long long> lengths;
+  lengths.reserve(part.lengths.size() + rest.lengths.size());
+  std::merge(part.lengths.begin(), part.lengths.end(), rest.lengths.begin(),
+             rest.lengths.end(), std::back_inserter(lengths),
+             std::greater<long long>());
+  lengths.erase(std::unique(lengths.begin(), lengths.end()), lengths.end());
+  auto position = [&lengths](long long len) {
+    return static_cast<int>(std::lower_bound(lengths.begin(), lengths.end(),
+                                             len, std::greater<long long>()) -
+                            lengths.begin());
+  };
+
+  std::vector<IdRuns> cutIds(lengths.size());
+  auto remap = [&](const Solution& from, std::vector<int>& to) {
+    to.resize(from.lengths.size());
+    for (size_t i = 0; i < from.lengths.size(); i++) {
+      to[i] = position(from.lengths[i]);
+      if (i < from.cut_ids.size()) {
+        cutIds[to[i]].insert(cutIds[to[i]].end(), from.cut_ids[i].begin(),
+                             from.cut_ids[i].end());
+      }
+    }
+  };
+  std::vector<int> restIndex, partIndex;
+  remap(rest, restIndex);
+  remap(part, partIndex);
+  for (auto& run : rest.runs) {
+    for (auto& piece : run.pieces) {
+      piece.first = restIndex[piece.first];
+    }
+  }
+  rest.runs.reserve(rest.runs.size() + part.runs.size());
+  for (const auto& run : part.runs) {
+    rest.runs.push_back(run);
+    for (auto& piece : rest.runs.back().pieces) {
+      piece.first = partIndex[piece.first];
+    }
+  }
+  rest.lengths = std::move(lengths);
+  rest.cut_ids = std::move(cutIds);
+
+  rest.num_sticks += part.num_sticks;
+  rest.total_waste += part.total_waste;
+  rest.total_cost += part.total_cost;
+  rest.stock_used.resize(std::max(rest.stock_used.size(),
+                                  part.stock_used.size()));
+  for (size_t t = 0; t < part.stock_used.size(); t++) {
+    rest.stock_used[t] += part.stock_used[t];
+  }
+  rest.offcuts.insert(rest.offcuts.end(), part.offcuts.begin(),
+                      part.offcuts.end());
+  std::sort(rest.offcuts.begin(), rest.offcuts.end(), std::greater<double>());
+  rest.stats.heuristic_ms += part.stats.heuristic_ms;
+  rest.stats.pattern_ms += part.stats.pattern_ms;
+  rest.stats.model_ms += part.stats.model_ms;
+  rest.stats.mip_ms += part.stats.mip_ms;
+  rest.stats.columns += part.stats.columns;
+  rest.stats.mip_nodes += part.stats.mip_nodes;
+  rest.stats.lp_iterations += part.stats.lp_iterations;
+  setSolveStatus(rest, rest.objective_bound + part.total_cost,
+                 rest.status == "optimal");
+  return rest;
+}
+
+/**
+ * @brief Cuts that fit on a stick only by themselves, in closed form.
+ *
+ * Each piece gets its own stick of the cheapest stock type long enough for
+ * it, which is optimal when stock is unlimited.
+ *
+ * @param lengths Scaled lengths of the fixed cuts, with their demand and
+ * the request entries their pieces came from.
+ * @param scale Integer units per inch of the scaled lengths.
+ */
+static Solution solveFixedCuts(const std::vector<long long>& lengths,
+                               const std::vector<int>& demand,
+                               std::vector<IdRuns> cutIds,
+                               const std::vector<StockOption>& scaledStock,
+                               const std::vector<StockType>& stock,
+                               double kerf, double scale,
+                               double offcutThreshold) {
+  Solution result;
+  result.lengths = lengths;
+  result.scale = scale;
+  result.cut_ids = std::move(cutIds);
+  result.stock_used.assign(stock.size(), 0);
+  for (size_t i = 0; i < lengths.size(); i++) {
+    size_t best = stock.size();
+    for (size_t t = 0; t < stock.size(); t++) {
+      if (scaledStock[t].available == 0 || scaledStock[t].length < lengths[i])
+        continue;
+      if (best == stock.size() || stock[t].cost < stock[best].cost ||
+          (stock[t].cost == stock[best].cost &&
+           stock[t].length < stock[best].length)) {
+        best = t;
+      }
+    }
+
+    double len = static_cast<double>(lengths[i]) / scale;
+    StickRun run;
+    run.pieces.emplace_back(static_cast<int>(i), 1);
+    run.count = demand[i];
+    run.stock_type = static_cast<int>(best);
+    run.stock_len = stock[best].length;
+    run.used_len = len;
+    run.waste_len = stock[best].length - len;
+    run.remnant = stock[best].remnant;
+    double offcut = run.waste_len - kerf;
+    if (offcutThreshold > 0 && offcut >= offcutThreshold) {
+      result.offcuts.insert(result.offcuts.end(), demand[i], offcut);
+    }
+    result.stock_used[best] += demand[i];
+    result.total_cost += demand[i] * stock[best].cost;
+    result.total_waste += demand[i] * run.waste_len;
+    result.num_sticks += demand[i];
+    result.runs.push_back(std::move(run));
+  }
+  std::sort(result.offcuts.begin(), result.offcuts.end(),
+            std::greater<double>());
+  result.status = "optimal";
+  result.objective_bound = result.total_cost;
+  return result;
+}
+
+// Pieces of each scaled length, ascending, on the scratch arena
+using PieceCounts = std::pmr::map<long long, long long>;
+
+// Signature over the settings and the ascending (scaled length, pieces)
+// pairs of a job
+static JobSignature jobSignature(const PieceCounts& pieces,
+                                 const std::vector<StockType>& stock,
+                                 double kerf, const SolverOptions& options) {
+  const double scale = unitScale(options.units);
+  JobSignature signature;
+  auto& words = signature.words;
+  words.push_back(static_cast<long long>(options.units));
+  words.push_back(stock.size());
+  for (const auto& type : stock) {
+    words.push_back(std::llround(type.length * scale));
+    words.push_back(doubleBits(type.cost));
+    words.push_back(type.available);
+    words.push_back(type.remnant);
+  }
+  words.push_back(std::llround(kerf * scale));
+  words.push_back(static_cast<long long>(options.mode));
+  words.push_back(static_cast<long long>(options.quality));
+  words.push_back(options.maximalPatterns);
+  words.push_back(doubleBits(options.timeLimitMs));
+  words.push_back(doubleBits(options.mipGap));
+  words.push_back(std::llround(options.offcutThreshold * scale));
+  for (const auto& [len, count] : pieces) {
+    words.push_back(len);
+    words.push_back(count);
+  }
+  signature.hash = hashWords(words);
+  return signature;
+}
+
+JobSignature makeJobSignature(const std::vector<Cut>& cuts,
+                              const std::vector<StockType>& stock, double kerf,
+                              const SolverOptions& options) {
+  ScratchScope scope;
+  const double scale = unitScale(options.units);
+  PieceCounts pieces(scratch());
+  for (const auto& cut : cuts) {
+    pieces[static_cast<long long>(std::round(cut.length * scale))]++;
+  }
+  return jobSignature(pieces, stock, kerf, options);
+}
+
+JobSignature makeJobSignature(const std::vector<Demand>& demands,
+                              const std::vector<StockType>& stock, double kerf,
+                              const SolverOptions& options) {
+  ScratchScope scope;
+  const double scale = unitScale(options.units);
+  PieceCounts pieces(scratch());
+  for (const auto& entry : demands) {
+    if (entry.quantity > 0)
+      pieces[static_cast<long long>(std::round(entry.length * scale))] +=
+          entry.quantity;
+  }
+  return jobSignature(pieces, stock, kerf, options);
+}
+
+JobSignature makeJobSignature(const std::vector<Cut>& cuts, double stockLen,
+                              double kerf, const SolverOptions& options) {
+  return makeJobSignature(cuts, {StockType(stockLen)}, kerf, options);
+}
+
+StockType remnantStock(double length, int count,
+                        const std::vector<StockType>& stock) {
+  double cheapestRate = 0.0;
+  for (const auto& type : stock) {
+    if (type.remnant || type.length <= 0)
+      continue;
+    double rate = type.cost / type.length;
+    if (cheapestRate == 0.0 || rate < cheapestRate)
+      cheapestRate = rate;
+  }
+  if (cheapestRate == 0.0)
+    cheapestRate = 1.0;
+  return StockType(length, REMNANT_COST_FACTOR * cheapestRate * length, count,
+                   true);
+}
 
 Solution optimizeCutting(const std::vector<Cut>& cuts, double stockLen,
-                         double kerf) {
-  // --- SCALING: Convert all double inputs to scaled integers ---
-  long long scaled_stockLen =
-      static_cast<long long>(std::round(stockLen * PRECISION_SCALE));
-  long long scaled_kerf =
-      static_cast<long long>(std::round(kerf * PRECISION_SCALE));
+                         double kerf, const SolverOptions& options) {
+  return optimizeCutting(cuts, {StockType(stockLen)}, kerf, options);
+}
+
+// Demand for one distinct scaled length, and the request entries it came
+// from as (id, pieces) runs
+struct LengthDemand {
+  int demand{0};
+  IdRuns ids;
+};
+
+// Distinct lengths of a job, longest first as the rows of the model are.
+// The table is scratch; its id runs are moved out before it goes.
+using DemandTable =
+    std::pmr::map<long long, LengthDemand, std::greater<long long>>;
 
-  // Create a list of all required cuts, scaled to integers
-  std::vector<long long> allScaledCuts;
+// Add `quantity` pieces of one request entry to the table
+static void addDemand(DemandTable& table, double length, double scale,
+                      int quantity, int id) {
+  LengthDemand& entry =
+      table[static_cast<long long>(std::round(length * scale))];
+  entry.demand += quantity;
+  if (!entry.ids.empty() && entry.ids.back().first == id) {
+    entry.ids.back().second += quantity;
+  } else {
+    entry.ids.emplace_back(id, quantity);
+  }
+}
+
+Solution optimizeCutting(const std::vector<Cut>& cuts,
+                         const std::vector<StockType>& stock, double kerf,
+                         const SolverOptions& options) {
+  ScratchScope scope;
+  DemandTable table(scratch());
   for (const auto& cut : cuts) {
-    allScaledCuts.push_back(
-        static_cast<long long>(std::round(cut.length * PRECISION_SCALE)));
+    addDemand(table, cut.length, unitScale(options.units), 1, cut.id);
+  }
+  std::vector<long long> lengths;
+  std::vector<int> demand;
+  std::vector<IdRuns> ids;
+  for (auto& [len, entry] : table) {
+    lengths.push_back(len);
+    demand.push_back(entry.demand);
+    ids.push_back(std::move(entry.ids));
+  }
+  return solveDemand(std::move(lengths), std::move(demand), std::move(ids),
+                     stock, kerf, options);
+}
+
+Solution optimizeCutting(const std::vector<Demand>& demands,
+                         const std::vector<StockType>& stock, double kerf,
+                         const SolverOptions& options) {
+  ScratchScope scope;
+  DemandTable table(scratch());
+  for (size_t k = 0; k < demands.size(); k++) {
+    if (demands[k].quantity > 0)
+      addDemand(table, demands[k].length, unitScale(options.units),
+                demands[k].quantity, static_cast<int>(k));
+  }
+  std::vector<long long> lengths;
+  std::vector<int> demand;
+  std::vector<IdRuns> ids;
+  for (auto& [len, entry] : table) {
+    lengths.push_back(len);
+    demand.push_back(entry.demand);
+    ids.push_back(std::move(entry.ids));
+  }
+  return solveDemand(std::move(lengths), std::move(demand), std::move(ids),
+                     stock, kerf, options);
+}
+
+/**
+ * @brief Signature of the model a job builds, which leaves out its demand.
+ *
+ * @param lengths Distinct scaled cut lengths, longest first.
+ * @param stock Scaled stock types.
+ * @param kerf Scaled kerf.
+ * @param maximalPatterns Whether the model covers demand with maximal
+ * patterns rather than meeting it exactly.
+ */
+static JobSignature modelSignature(const std::vector<long long>& lengths,
+                                   const std::vector<StockOption>& stock,
+                                   long long kerf, bool maximalPatterns) {
+  JobSignature signature;
+  auto& words = signature.words;
+  words.push_back(stock.size());
+  for (const auto& option : stock) {
+    words.push_back(option.length);
+    words.push_back(doubleBits(option.cost));
+    words.push_back(option.available);
+    words.push_back(option.remnant);
+  }
+  words.push_back(kerf);
+  words.push_back(maximalPatterns);
+  words.insert(words.end(), lengths.begin(), lengths.end());
+  signature.hash = hashWords(words);
+  return signature;
+}
+
+/**
+ * @brief Adapts a plan made for other quantities of the same lengths.
+ *
+ * Sticks are kept whole while all their pieces are still wanted, then cut
+ * down to the pieces that are; whatever is still missing is packed
+ * First-Fit on the longest stock left and moved onto the cheapest stock it
+ * fits. A one-row edit so keeps nearly all of the earlier plan.
+ *
+ * @param plan Plan over the demand rows.
+ * @param lengths Distinct scaled cut lengths, longest first.
+ * @param demand Pieces now wanted of each length.
+ * @return The adapted plan, or an empty packing when the missing pieces do
+ * not fit within the availability caps.
+ */
+static Packing repairPlan(const Packing& plan,
+                          const std::vector<long long>& lengths,
+                          const std::vector<int>& demand, long long kerf,
+                          const std::vector<StockOption>& stock) {
+  const PatternSet& layouts = plan.patterns;
+  Packing repaired;
+  repaired.patterns.lengths = lengths;
+  std::vector<int> missing = demand;
+  for (size_t p = 0; p < layouts.size(); p++) {
+    int whole = plan.multiplicity[p];
+    for (HighsInt k = layouts.start[p]; k < layouts.start[p + 1]; k++) {
+      whole = std::min(whole, missing[layouts.index[k]] /
+                                  static_cast<int>(layouts.value[k]));
+    }
+    if (whole > 0) {
+      appendPatterns(repaired.patterns, layouts, p, p + 1, -1);
+      repaired.multiplicity.push_back(whole);
+      repaired.stock.push_back(plan.stock[p]);
+      for (HighsInt k = layouts.start[p]; k < layouts.start[p + 1]; k++) {
+        missing[layouts.index[k]] -=
+            whole * static_cast<int>(layouts.value[k]);
+      }
+    }
+    // Each cut-down stick runs out of at least one length, so this stops
+    // after a few sticks
+    for (int stick = whole; stick < plan.multiplicity[p]; stick++) {
+      size_t before = repaired.patterns.index.size();
+      for (HighsInt k = layouts.start[p]; k < layouts.start[p + 1]; k++) {
+        int take = std::min(static_cast<int>(layouts.value[k]),
+                            missing[layouts.index[k]]);
+        if (take > 0) {
+          repaired.patterns.index.push_back(layouts.index[k]);
+          repaired.patterns.value.push_back(take);
+          missing[layouts.index[k]] -= take;
+        }
+      }
+      if (repaired.patterns.index.size() == before)
+        break;
+      repaired.patterns.start.push_back(repaired.patterns.index.size());
+      repaired.multiplicity.push_back(1);
+      repaired.stock.push_back(plan.stock[p]);
+    }
+  }
+
+  auto firstMissing = std::find_if(missing.begin(), missing.end(),
+                                   [](int left) { return left > 0; });
+  if (firstMissing == missing.end())
+    return repaired;
+
+  std::vector<StockOption> spare = stock;
+  for (size_t p = 0; p < repaired.patterns.size(); p++) {
+    if (spare[repaired.stock[p]].available > 0) {
+      spare[repaired.stock[p]].available -= repaired.multiplicity[p];
+    }
+  }
+  long long longest = 0;
+  for (const auto& option : spare) {
+    if (option.available != 0)
+      longest = std::max(longest, option.length);
+  }
+  if (longest < lengths[firstMissing - missing.begin()])
+    return Packing();
+  Packing extra = assignStock(
+      firstFitDecreasing(lengths, missing, longest, kerf), kerf, spare);
+  if (extra.patterns.size() == 0)
+    return Packing();
+  appendPatterns(repaired.patterns, extra.patterns, 0, extra.patterns.size(),
+                 -1);
+  repaired.multiplicity.insert(repaired.multiplicity.end(),
+                               extra.multiplicity.begin(),
+                               extra.multiplicity.end());
+  repaired.stock.insert(repaired.stock.end(), extra.stock.begin(),
+                        extra.stock.end());
+  return repaired;
+}
+
+/**
+ * @brief Collects the columns a MIP solution uses as a packing.
+ *
+ * @param columns The model's constraint matrix.
+ * @param colValue Sticks cut with each column.
+ * @param columnStock Stock type of each column.
+ * @param numLengths Demand rows; entries in the availability rows below
+ * them are left out.
+ */
+static Packing packingFromColumns(const HighsSparseMatrix& columns,
+                                  const std::vector<double>& colValue,
+                                  const std::vector<int>& columnStock,
+                                  size_t numLengths) {
+  Packing packing;
+  for (size_t p = 0; p < colValue.size(); p++) {
+    int sticks = static_cast<int>(std::llround(colValue[p]));
+    if (sticks <= 0)
+      continue;
+    for (HighsInt k = columns.start_[p]; k < columns.start_[p + 1]; k++) {
+      if (static_cast<size_t>(columns.index_[k]) < numLengths) {
+        packing.patterns.index.push_back(columns.index_[k]);
+        packing.patterns.value.push_back(columns.value_[k]);
+      }
+    }
+    packing.patterns.start.push_back(packing.patterns.index.size());
+    packing.multiplicity.push_back(sticks);
+    packing.stock.push_back(columnStock[p]);
   }
+  return packing;
+}
 
-  // Generate valid patterns using scaled integers
-  auto patterns = generatePatterns(allScaledCuts, scaled_stockLen, scaled_kerf);
-  if (patterns.empty()) {
+/**
+ * @brief Solves a job given as its distinct scaled lengths and their demand.
+ *
+ * @param uniqueCutKeys Distinct scaled cut lengths, longest first.
+ * @param demand Pieces wanted of each length.
+ * @param cutIds Request entries each length's pieces came from, as (id,
+ * pieces) runs in request order.
+ */
+static Solution solveDemand(std::vector<long long> uniqueCutKeys,
+                            std::vector<int> demand,
+                            std::vector<IdRuns> cutIds,
+                            const std::vector<StockType>& stock, double kerf,
+                            const SolverOptions& options) {
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point startTime = Clock::now();
+  const Clock::time_point deadline =
+      options.timeLimitMs > 0
+          ? startTime + std::chrono::duration_cast<Clock::duration>(
+                            std::chrono::duration<double, std::milli>(
+                                options.timeLimitMs))
+          : Clock::time_point::max();
+  auto remainingMs = [&deadline]() {
+    if (deadline == Clock::time_point::max())
+      return kHighsInf;
+    std::chrono::duration<double, std::milli> left = deadline - Clock::now();
+    return std::max(0.0, left.count());
+  };
+  // Phase times for Solution::stats: milliseconds since the previous lap
+  SolveStats stats;
+  Clock::time_point lapStart = startTime;
+  auto lap = [&lapStart]() {
+    Clock::time_point now = Clock::now();
+    std::chrono::duration<double, std::milli> taken = now - lapStart;
+    lapStart = now;
+    return taken.count();
+  };
+
+  // --- SCALING: Convert all double inputs to scaled integers ---
+  const double scale = unitScale(options.units);
+  std::vector<StockOption> scaled_stock;
+  long long longestStock = 0;
+  for (const auto& type : stock) {
+    StockOption option;
+    option.length =
+        static_cast<long long>(std::round(type.length * scale));
+    option.cost = type.cost;
+    option.available = type.available;
+    option.remnant = type.remnant;
+    scaled_stock.push_back(option);
+    if (type.available != 0) {
+      longestStock = std::max(longestStock, option.length);
+    }
+  }
+  long long scaled_kerf = static_cast<long long>(std::round(kerf * scale));
+
+  if (uniqueCutKeys.empty() || uniqueCutKeys.front() > longestStock) {
     std::cerr << "Error: no valid cutting patterns could be generated. "
                  "Check if any cut is larger than the stock length."
               << std::endl;
     return Solution();
   }
 
-  // Step 2: Build the Mixed-Integer Programming (MIP) model using HiGHS
-  Highs highs;
-  highs.setOptionValue("output_flag", false);
-  HighsModel model;
+  const size_t numLengths = uniqueCutKeys.size();
+
+  // Decomposition: two lengths can share a stick when their weights fit
+  // the longest stock together. That relation is a threshold graph, so every
+  // length that pairs with anything pairs with the shortest one and they all
+  // form a single cluster; the lengths too long to pair even with the
+  // shortest are cut one per stick. Those are solved in closed form and only
+  // the rest goes to the MIP. Availability caps couple the two parts, so the
+  // split is only made for unlimited stock.
+  const bool unlimitedStock =
+      std::all_of(scaled_stock.begin(), scaled_stock.end(),
+                  [](const StockOption& option) {
+                    return option.available <= 0;
+                  });
+  const long long shortestWeight = uniqueCutKeys.back() + scaled_kerf;
+  size_t firstShared = 0;
+  while (firstShared < numLengths &&
+         uniqueCutKeys[firstShared] + scaled_kerf + shortestWeight >
+             longestStock + scaled_kerf) {
+    firstShared++;
+  }
+  if (unlimitedStock && firstShared > 0) {
+    std::vector<long long> fixedLengths(uniqueCutKeys.begin(),
+                                        uniqueCutKeys.begin() + firstShared);
+    std::vector<int> fixedDemand(demand.begin(), demand.begin() + firstShared);
+    std::vector<IdRuns> fixedIds(cutIds.begin(), cutIds.begin() + firstShared);
+    auto fixed = std::make_shared<const Solution>(solveFixedCuts(
+        fixedLengths, fixedDemand, std::move(fixedIds), scaled_stock, stock,
+        kerf, scale, options.offcutThreshold));
+    if (firstShared == numLengths)
+      return *fixed;
+    std::cerr << "Decomposition: " << fixed->num_sticks
+              << " cuts fixed one per stick, solving the remaining "
+              << numLengths - firstShared << " lengths" << std::endl;
+
+    SolverOptions restOptions = options;
+    if (options.timeLimitMs > 0) {
+      restOptions.timeLimitMs = std::max(remainingMs(), 1.0);
+    }
+    if (options.onProgress) {
+      restOptions.onProgress = [fixed, &options](const SolveProgress& part) {
+        SolveProgress progress = part;
+        progress.objective += fixed->total_cost;
+        progress.bound += fixed->total_cost;
+        progress.gap = progress.objective > 0
+                           ? std::max(0.0, (progress.objective -
+                                            progress.bound) /
+                                               progress.objective)
+                           : 0.0;
+        if (part.incumbent) {
+          progress.incumbent = std::make_shared<const Solution>(
+              mergeSolutions(*fixed, *part.incumbent));
+        }
+        options.onProgress(progress);
+      };
+    }
+    Solution solution = solveDemand(
+        std::vector<long long>(uniqueCutKeys.begin() + firstShared,
+                               uniqueCutKeys.end()),
+        std::vector<int>(demand.begin() + firstShared, demand.end()),
+        std::vector<IdRuns>(cutIds.begin() + firstShared, cutIds.end()),
+        stock, kerf, restOptions);
+    if (solution.num_sticks == 0)
+      return solution;
+    return mergeSolutions(*fixed, std::move(solution));
+  }
+  const size_t numStock = scaled_stock.size();
+
+  // Continuous lower bound on the cost. With one uncapped stock type it is
+  // the rounded-up stick count; otherwise the total length is priced by
+  // filling the cheapest stock per unit of length first, as far as its
+  // availability allows.
+  double lowerBound = 0.0;
+  if (numStock == 1 && scaled_stock[0].available < 0) {
+    lowerBound = scaled_stock[0].cost *
+                 stickLowerBound(uniqueCutKeys, demand,
+                                 scaled_stock[0].length, scaled_kerf);
+  } else {
+    double totalWeight = 0.0;
+    for (size_t i = 0; i < numLengths; i++) {
+      totalWeight +=
+          static_cast<double>(uniqueCutKeys[i] + scaled_kerf) * demand[i];
+    }
+    std::vector<size_t> byRate;
+    for (size_t t = 0; t < numStock; t++) {
+      if (scaled_stock[t].available != 0)
+        byRate.push_back(t);
+    }
+    auto rate = [&](size_t t) {
+      return scaled_stock[t].cost / (scaled_stock[t].length + scaled_kerf);
+    };
+    std::sort(byRate.begin(), byRate.end(),
+              [&](size_t a, size_t b) { return rate(a) < rate(b); });
+    for (size_t t : byRate) {
+      if (totalWeight <= 0)
+        break;
+      double length = static_cast<double>(scaled_stock[t].length + scaled_kerf);
+      double take = scaled_stock[t].available < 0
+                        ? totalWeight
+                        : std::min(totalWeight,
+                                   length * scaled_stock[t].available);
+      lowerBound += take * rate(t);
+      totalWeight -= take;
+    }
+  }
 
-  // Create a map to track the demand for each unique cut length
-  std::unordered_map<long long, int> cutDemand;
-  for (long long scaled_len : allScaledCuts) {
-    cutDemand[scaled_len]++;
+  // A model kept from an earlier job over the same lengths and stock is
+  // reused when no other solve holds it. Its bound still holds when no
+  // quantity went down, since dropping pieces never costs more.
+  const bool exhaustive = options.mode == SolverMode::Exhaustive;
+  JobSignature modelKey;
+  std::shared_ptr<CachedModel> reused;
+  std::unique_lock<std::mutex> reusedLock;
+  if (exhaustive) {
+    modelKey = modelSignature(uniqueCutKeys, scaled_stock, scaled_kerf,
+                              options.maximalPatterns);
+    if (modelCache().get(modelKey, reused)) {
+      reusedLock = std::unique_lock<std::mutex>(reused->mutex,
+                                                std::try_to_lock);
+      if (!reusedLock.owns_lock())
+        reused.reset();
+    }
+  }
+  if (reused) {
+    bool noneFewer = true;
+    for (size_t i = 0; i < numLengths; i++) {
+      noneFewer = noneFewer && demand[i] >= reused->demand[i];
+    }
+    if (noneFewer) {
+      lowerBound = std::max(lowerBound, reused->bound);
+    }
   }
+  const double boundTolerance = 1e-6 * std::max(1.0, lowerBound);
 
-  // Extract unique keys for consistent row ordering
-  std::vector<long long> uniqueCutKeys;
-  for (const auto& [len, demand] : cutDemand) {
-    uniqueCutKeys.push_back(len);
+  // Step 1: Greedy packings give an incumbent and, together with the
+  // continuous bound, often a proven optimum without touching the MIP. Each
+  // stock length is tried as the bin size, then sticks are moved onto the
+  // cheapest stock they fit on. When remnants are on hand the packings are
+  // also tried on the pieces left after filling the remnants first.
+  std::vector<int> residual = demand;
+  Packing remnantFill =
+      fillRemnants(uniqueCutKeys, residual, scaled_kerf, scaled_stock);
+  std::vector<StockOption> residualStock = scaled_stock;
+  for (size_t p = 0; p < remnantFill.patterns.size(); p++) {
+    residualStock[remnantFill.stock[p]].available -=
+        remnantFill.multiplicity[p];
   }
-  std::sort(uniqueCutKeys.begin(), uniqueCutKeys.end());
+  const bool remnantsCoverAll =
+      remnantFill.patterns.size() > 0 &&
+      std::all_of(residual.begin(), residual.end(),
+                  [](int left) { return left == 0; });
 
-  // Variables: one integer variable per pattern
-  model.lp_.num_col_ = patterns.size();
-  model.lp_.col_cost_.assign(patterns.size(),
-                             1.0); // Objective: minimize # of sticks
-  model.lp_.col_lower_.assign(patterns.size(), 0.0);
-  model.lp_.col_upper_.assign(patterns.size(), kHighsInf);
-  model.lp_.integrality_.assign(patterns.size(), HighsVarType::kInteger);
+  Packing incumbent;
+  double incumbentCost = std::numeric_limits<double>::infinity();
+  auto consider = [&](Packing&& candidate) {
+    if (candidate.patterns.size() == 0)
+      return;
+    double cost = candidate.cost(scaled_stock);
+    if (cost < incumbentCost) {
+      incumbentCost = cost;
+      incumbent = std::move(candidate);
+    }
+  };
+  if (remnantsCoverAll) {
+    consider(Packing(remnantFill));
+  }
+  // Once the time limit is up, the best packing so far stands
+  auto outOfTime = [&]() {
+    return incumbent.patterns.size() > 0 && Clock::now() >= deadline;
+  };
+  using Packer = Packing (*)(const std::vector<long long>&,
+                             const std::vector<int>&, long long, long long);
+  const Packer packers[] = {firstFitDecreasing, bestFitDecreasing};
+  for (const auto& option : scaled_stock) {
+    if (option.available == 0 || option.length < uniqueCutKeys.front())
+      continue;
+    for (Packer pack : packers) {
+      if (outOfTime())
+        break;
+      consider(assignStock(
+          pack(uniqueCutKeys, demand, option.length, scaled_kerf),
+          scaled_kerf, scaled_stock));
+    }
+    if (remnantFill.patterns.size() == 0 || remnantsCoverAll)
+      continue;
+    for (Packer pack : packers) {
+      if (outOfTime())
+        break;
+      Packing fitted = assignStock(
+          pack(uniqueCutKeys, residual, option.length, scaled_kerf),
+          scaled_kerf, residualStock);
+      if (fitted.patterns.size() == 0)
+        continue;
+      Packing combined = remnantFill;
+      appendPatterns(combined.patterns, fitted.patterns, 0,
+                     fitted.patterns.size(), -1);
+      combined.multiplicity.insert(combined.multiplicity.end(),
+                                   fitted.multiplicity.begin(),
+                                   fitted.multiplicity.end());
+      combined.stock.insert(combined.stock.end(), fitted.stock.begin(),
+                            fitted.stock.end());
+      consider(std::move(combined));
+    }
+  }
+  // The earlier plan, adapted, often beats the greedy packings outright
+  if (reused) {
+    consider(repairPlan(reused->plan, uniqueCutKeys, demand, scaled_kerf,
+                        scaled_stock));
+  }
+  const bool haveIncumbent = incumbent.patterns.size() > 0;
+  stats.heuristic_ms = lap();
 
-  // Constraints: one for each unique cut length required
-  model.lp_.num_row_ = cutDemand.size();
-  model.lp_.row_lower_.resize(cutDemand.size());
-  model.lp_.row_upper_.resize(cutDemand.size());
+  auto incumbentSolution = [&]() {
+    std::vector<double> colValue(incumbent.multiplicity.begin(),
+                                 incumbent.multiplicity.end());
+    Solution solution = buildSolution(
+        uniqueCutKeys, cutIds, demand, false, incumbent.patterns.start,
+        incumbent.patterns.index, incumbent.patterns.value, colValue,
+        incumbent.stock, stock, kerf, scale, options.offcutThreshold);
+    solution.status = "heuristic";
+    setSolveStatus(solution, lowerBound, false);
+    solution.stats = stats;
+    return solution;
+  };
 
-  // Build the constraint matrix A (in column-wise format)
-  std::vector<int> Astart = {0};
-  std::vector<int> Aindex;
-  std::vector<double> Avalue;
+  // Reports go out from here and from the MIP callback below
+  auto elapsedMs = [&startTime]() {
+    std::chrono::duration<double, std::milli> taken = Clock::now() - startTime;
+    return taken.count();
+  };
+  auto reportProgress = [&](std::shared_ptr<const Solution> plan,
+                            double objective, double bound) {
+    SolveProgress progress;
+    progress.elapsedMs = elapsedMs();
+    progress.objective = objective;
+    progress.bound = bound;
+    progress.gap =
+        objective > 0 ? std::max(0.0, (objective - bound) / objective) : 0.0;
+    progress.incumbent = std::move(plan);
+    options.onProgress(progress);
+  };
 
-  for (const auto& pattern : patterns) {
-    std::unordered_map<long long, int> patternCounts;
-    for (long long piece : pattern) {
-      patternCounts[piece]++;
+  if (haveIncumbent && (options.quality == SolveQuality::Fast ||
+                        incumbentCost <= lowerBound + boundTolerance)) {
+    if (reused && incumbentCost <= lowerBound + boundTolerance) {
+      reused->demand = demand;
+      reused->plan = incumbent;
+      reused->bound = lowerBound;
     }
+    return incumbentSolution();
+  }
+  if (outOfTime()) {
+    std::cerr << "Time limit reached in the heuristics, returning the best "
+                 "packing"
+              << std::endl;
+    return incumbentSolution();
+  }
+  if (haveIncumbent && options.onProgress) {
+    reportProgress(std::make_shared<const Solution>(incumbentSolution()),
+                   incumbentCost, lowerBound);
+  }
 
-    for (size_t i = 0; i < uniqueCutKeys.size(); ++i) {
-      long long cutLen = uniqueCutKeys[i];
-      if (patternCounts.count(cutLen) > 0) {
-        Aindex.push_back(i);
-        Avalue.push_back(patternCounts[cutLen]);
+  // Column generation and maximal patterns may over-produce a length, so
+  // their master covers demand (>=) and the surplus pieces are trimmed
+  // afterwards. The full exhaustive set contains every exact combination, so
+  // it can use equality.
+  std::vector<std::shared_ptr<const PatternSet>> enumerated(numStock);
+  std::vector<PatternSet> generated;
+  bool columnGeneration = options.mode == SolverMode::ColumnGeneration;
+  bool coverDemand = columnGeneration || options.maximalPatterns;
+  if (!columnGeneration && !reused) {
+    // Generate valid patterns per stock length using scaled integers,
+    // within whatever is left of the time limit and pattern budget
+    size_t totalPatterns = 0;
+    for (size_t t = 0; t < numStock && !columnGeneration; t++) {
+      if (scaled_stock[t].available == 0) {
+        enumerated[t] = std::make_shared<const PatternSet>();
+        continue;
+      }
+      PatternBudget budget = options.patternBudget;
+      budget.maxMillis = std::min(budget.maxMillis, remainingMs());
+      budget.maxPatterns -= std::min(budget.maxPatterns, totalPatterns);
+      enumerated[t] =
+          cachedPatterns(uniqueCutKeys, scaled_stock[t].length, scaled_kerf,
+                         options.maximalPatterns, budget,
+                         options.enumerationThreads);
+      totalPatterns += enumerated[t]->size();
+      if (enumerated[t]->truncated) {
+        std::cerr << "Pattern budget exhausted after " << totalPatterns
+                  << " patterns, falling back to column generation"
+                  << std::endl;
+        columnGeneration = coverDemand = true;
       }
     }
-    Astart.push_back(Aindex.size());
+  }
+  if (columnGeneration) {
+    generated = generateColumns(uniqueCutKeys, demand, scaled_stock,
+                                scaled_kerf, incumbent,
+                                options.maxPricingRounds, deadline);
+  }
+  stats.pattern_ms = lap();
+  if (remainingMs() <= 0 && haveIncumbent) {
+    std::cerr << "Time limit reached before the MIP, returning heuristic"
+              << std::endl;
+    return incumbentSolution();
   }
 
-  for (size_t i = 0; i < uniqueCutKeys.size(); ++i) {
-    model.lp_.row_lower_[i] = cutDemand[uniqueCutKeys[i]];
-    model.lp_.row_upper_[i] =
-        cutDemand[uniqueCutKeys[i]]; // Enforce exact quantity
+  // Capped stock types get an availability row below the demand rows
+  std::vector<HighsInt> availabilityRow(numStock, -1);
+  size_t numRows = numLengths;
+  for (size_t t = 0; t < numStock; t++) {
+    if (scaled_stock[t].available > 0) {
+      availabilityRow[t] = numRows++;
+    }
   }
 
-  model.lp_.a_matrix_.format_ = MatrixFormat::kColwise;
-  model.lp_.a_matrix_.start_ = Astart;
-  model.lp_.a_matrix_.index_ = Aindex;
-  model.lp_.a_matrix_.value_ = Avalue;
-  model.lp_.sense_ = ObjSense::kMinimize;
+  // The model is either the kept one, which only needs this job's demand
+  // and warm start columns, or built here and kept after the solve
+  std::shared_ptr<CachedModel> kept =
+      reused ? reused : std::make_shared<CachedModel>();
+  Highs& highs = kept->highs;
+  std::vector<int>& columnStock = kept->columnStock;
+  size_t firstIncumbentColumn = 0;
+  if (reused) {
+    // Replace the last solve's incumbent columns with this one's
+    HighsInt numCols = highs.getNumCol();
+    if (numCols > static_cast<HighsInt>(kept->baseColumns)) {
+      highs.deleteCols(kept->baseColumns, numCols - 1);
+    }
+    columnStock.resize(kept->baseColumns);
+    firstIncumbentColumn = kept->baseColumns;
+    PatternSet added;
+    std::vector<double> addedCost;
+    for (size_t p = 0; p < incumbent.patterns.size(); p++) {
+      int t = incumbent.stock[p];
+      appendPatterns(added, incumbent.patterns, p, p + 1,
+                     availabilityRow[t]);
+      addedCost.push_back(scaled_stock[t].cost);
+      columnStock.push_back(t);
+    }
+    if (added.size() > 0) {
+      std::vector<double> lower(added.size(), 0.0);
+      std::vector<double> upper(added.size(), kHighsInf);
+      std::vector<HighsVarType> integrality(added.size(),
+                                            HighsVarType::kInteger);
+      highs.addCols(added.size(), addedCost.data(), lower.data(),
+                    upper.data(), added.index.size(), added.start.data(),
+                    added.index.data(), added.value.data());
+      highs.changeColsIntegrality(firstIncumbentColumn,
+                                  columnStock.size() - 1, integrality.data());
+    }
+    std::vector<double> rowLower(demand.begin(), demand.end());
+    std::vector<double> rowUpper =
+        coverDemand ? std::vector<double>(numLengths, kHighsInf) : rowLower;
+    highs.changeRowsBounds(0, numLengths - 1, rowLower.data(),
+                           rowUpper.data());
+  } else {
+    // Lay every stock type's patterns side by side as the columns of A. The
+    // cached sets are shared, so they are copied once, straight into arrays
+    // that are later moved into the model. The incumbent's layouts are
+    // appended so it can be passed as a MIP start even when the pattern set is
+    // pruned or generated.
+    std::vector<const PatternSet*> sources(numStock);
+    size_t reserveColumns = incumbent.patterns.size();
+    size_t reserveNonzeros = incumbent.patterns.index.size() + reserveColumns;
+    for (size_t t = 0; t < numStock; t++) {
+      sources[t] = columnGeneration ? &generated[t] : enumerated[t].get();
+      reserveColumns += sources[t]->size();
+      reserveNonzeros += sources[t]->index.size() + sources[t]->size();
+    }
+
+    PatternSet patterns;
+    patterns.start.reserve(reserveColumns + 1);
+    patterns.index.reserve(reserveNonzeros);
+    patterns.value.reserve(reserveNonzeros);
+    columnStock.reserve(reserveColumns);
+    for (size_t t = 0; t < numStock; t++) {
+      appendPatterns(patterns, *sources[t], 0, sources[t]->size(),
+                     availabilityRow[t]);
+      columnStock.insert(columnStock.end(), sources[t]->size(), t);
+    }
+    firstIncumbentColumn = patterns.size();
+    for (size_t p = 0; p < incumbent.patterns.size(); p++) {
+      int t = incumbent.stock[p];
+      appendPatterns(patterns, incumbent.patterns, p, p + 1,
+                     availabilityRow[t]);
+      columnStock.push_back(t);
+    }
+    enumerated.clear();
+    generated.clear();
+
+    if (patterns.size() == 0) {
+      std::cerr << "Error: no valid cutting patterns could be generated. "
+                   "Check the stock lengths and availability."
+                << std::endl;
+      return Solution();
+    }
+
+    // Step 2: Build the Mixed-Integer Programming (MIP) model using HiGHS
+    const size_t numPatterns = patterns.size();
+    HighsModel model;
+
+    // Variables: one integer variable per pattern, costing its stock type
+    // (minimizes the number of sticks when every type costs 1)
+    model.lp_.num_col_ = numPatterns;
+    model.lp_.col_cost_.resize(numPatterns);
+    for (size_t p = 0; p < numPatterns; p++) {
+      model.lp_.col_cost_[p] = scaled_stock[columnStock[p]].cost;
+    }
+    model.lp_.col_lower_.assign(numPatterns, 0.0);
+    model.lp_.col_upper_.assign(numPatterns, kHighsInf);
+    model.lp_.integrality_.assign(numPatterns, HighsVarType::kInteger);
+
+    // Constraints: one for each unique cut length required, then one for
+    // each stock type with a limited number of sticks
+    model.lp_.num_row_ = numRows;
+    model.lp_.row_lower_.resize(numRows);
+    model.lp_.row_upper_.resize(numRows);
 
-  // Step 3: Solve the MIP model with HiGHS
-  highs.passModel(model);
+    for (size_t i = 0; i < numLengths; ++i) {
+      model.lp_.row_lower_[i] = demand[i];
+      model.lp_.row_upper_[i] =
+          coverDemand ? kHighsInf : demand[i]; // Enforce exact quantity
+    }
+    for (size_t t = 0; t < numStock; t++) {
+      if (availabilityRow[t] >= 0) {
+        model.lp_.row_lower_[availabilityRow[t]] = 0.0;
+        model.lp_.row_upper_[availabilityRow[t]] = scaled_stock[t].available;
+      }
+    }
+
+    // The pattern set already is the constraint matrix A in column-wise
+    // format, so hand its arrays over instead of rebuilding them
+    model.lp_.a_matrix_.format_ = MatrixFormat::kColwise;
+    model.lp_.a_matrix_.start_ = std::move(patterns.start);
+    model.lp_.a_matrix_.index_ = std::move(patterns.index);
+    model.lp_.a_matrix_.value_ = std::move(patterns.value);
+    model.lp_.sense_ = ObjSense::kMinimize;
+
+    highs.passModel(std::move(model));
+    kept->baseColumns = firstIncumbentColumn;
+  }
+  const size_t numPatterns = columnStock.size();
+
+  // Step 3: Solve the MIP model with HiGHS, starting from the incumbent.
+  // Options are set on every solve, as a kept model still has the last.
+  highs.setOptionValue("output_flag", false);
+  highs.setOptionValue("mip_rel_gap", options.mipGap);
+  highs.setOptionValue("time_limit", options.timeLimitMs > 0
+                                         ? remainingMs() / 1000.0
+                                         : kHighsInf);
+  if (haveIncumbent) {
+    HighsSolution start;
+    start.col_value.assign(numPatterns, 0.0);
+    for (size_t p = 0; p < incumbent.multiplicity.size(); p++) {
+      start.col_value[firstIncumbentColumn + p] = incumbent.multiplicity[p];
+    }
+    highs.setSolution(start);
+  }
+  stats.model_ms = lap();
+  stats.columns = static_cast<long long>(numPatterns);
+
+  // An incumbent that meets the continuous bound is optimal and there is
+  // nothing left to prove. Improved incumbents and, now and then, the bound
+  // are reported to the progress hook.
+  bool reachedBound = false;
+  double lastReportMs = -PROGRESS_INTERVAL_MS;
+  highs.setCallback([&](int callbackType, const std::string&,
+                        const HighsCallbackDataOut* dataOut,
+                        HighsCallbackDataIn* dataIn, void*) {
+    double bound = std::max(lowerBound, dataOut->mip_dual_bound);
+    if (callbackType == kCallbackMipImprovingSolution) {
+      const HighsSparseMatrix& columns = highs.getLp().a_matrix_;
+      std::vector<double> colValue(dataOut->mip_solution,
+                                   dataOut->mip_solution + numPatterns);
+      auto plan = std::make_shared<Solution>(buildSolution(
+          uniqueCutKeys, cutIds, demand, coverDemand, columns.start_,
+          columns.index_, columns.value_, colValue, columnStock, stock, kerf,
+          scale, options.offcutThreshold));
+      plan->status = "feasible";
+      setSolveStatus(*plan, bound, false);
+      reportProgress(plan, dataOut->mip_primal_bound, bound);
+      lastReportMs = elapsedMs();
+      return;
+    }
+    if (callbackType != kCallbackMipInterrupt)
+      return;
+    if (dataOut->mip_primal_bound <= lowerBound + boundTolerance) {
+      reachedBound = true;
+      dataIn->user_interrupt = 1;
+    } else if (options.onProgress &&
+               elapsedMs() - lastReportMs >= PROGRESS_INTERVAL_MS &&
+               dataOut->mip_primal_bound < kHighsInf) {
+      reportProgress(nullptr, dataOut->mip_primal_bound, bound);
+      lastReportMs = elapsedMs();
+    }
+  });
+  highs.startCallback(kCallbackMipInterrupt);
+  if (options.onProgress) {
+    highs.startCallback(kCallbackMipImprovingSolution);
+  }
   highs.run();
+  // The callback refers to this frame, which a kept model outlives
+  highs.stopCallback(kCallbackMipInterrupt);
+  highs.stopCallback(kCallbackMipImprovingSolution);
 
-  if (highs.getModelStatus() != HighsModelStatus::kOptimal) {
-    std::cerr << "HiGHS could not find an optimal solution. Status: "
-              << highs.modelStatusToString(highs.getModelStatus()) << std::endl;
-    return Solution();
+  // A solve stopped by the time limit or gap still holds a usable
+  // incumbent; only fall back to the greedy packing when it has none
+  HighsModelStatus status = highs.getModelStatus();
+  const HighsInfo& info = highs.getInfo();
+  stats.mip_ms = lap();
+  stats.mip_nodes = info.mip_node_count;
+  stats.lp_iterations = info.simplex_iteration_count;
+  if (info.primal_solution_status != kSolutionStatusFeasible) {
+    std::cerr << "HiGHS returned no incumbent. Status: "
+              << highs.modelStatusToString(status) << std::endl;
+    if (haveIncumbent)
+      return incumbentSolution();
+    Solution infeasible;
+    if (status == HighsModelStatus::kInfeasible) {
+      infeasible.status = "infeasible";
+    }
+    infeasible.stats = stats;
+    return infeasible;
+  }
+
+  // Step 4: Convert the solver output; the patterns now live in the
+  // solver's copy of the matrix
+  const HighsSparseMatrix& columns = highs.getLp().a_matrix_;
+  Solution result = buildSolution(
+      uniqueCutKeys, cutIds, demand, coverDemand, columns.start_,
+      columns.index_, columns.value_, highs.getSolution().col_value,
+      columnStock, stock, kerf, scale, options.offcutThreshold);
+
+  bool proven = reachedBound || (status == HighsModelStatus::kOptimal &&
+                                 info.mip_gap <= 1e-9);
+  result.status = "feasible";
+  result.stats = stats;
+  setSolveStatus(result, std::max(lowerBound, info.mip_dual_bound), proven);
+  if (status != HighsModelStatus::kOptimal && !reachedBound) {
+    std::cerr << "HiGHS stopped early (" << highs.modelStatusToString(status)
+              << "), returning incumbent with gap " << result.mip_gap
+              << std::endl;
+  }
+
+  // Keep the model and this plan for the next edit of the job
+  if (exhaustive && !columnGeneration) {
+    kept->demand = demand;
+    kept->plan = packingFromColumns(columns, highs.getSolution().col_value,
+                                    columnStock, numLengths);
+    kept->bound = result.objective_bound;
+    if (!reused) {
+      modelCache().put(modelKey, kept);
+    }
   }
+  return result;
+}
 
-  // Step 4: Convert the solver output, scaling back to doubles
-  const HighsSolution& solution = highs.getSolution();
+/**
+ * @brief Turns the chosen patterns into runs of identical sticks.
+ *
+ * Piece lengths stay in scaled integers; only the per-run stock, used and
+ * waste lengths are converted back to inches. When surplus pieces are
+ * trimmed the first sticks of a pattern can differ from the rest, so each
+ * pattern yields one run per distinct layout, and the sticks after the last
+ * trim are counted in bulk.
+ *
+ * @param cutIds Request entries of each length's pieces, as (id, pieces) runs.
+ * @param coverDemand Whether the columns may over-produce a length. Pieces
+ * beyond the demand are then dropped from the sticks so the plan cuts exactly
+ * what was ordered, and counted in `surplus_pieces`.
+ * @param start,index,value The patterns in column-wise sparse format. Rows
+ * past the cut lengths (stock availability) are ignored.
+ * @param colValue How many sticks are cut with each pattern.
+ * @param columnStock Stock type each pattern is cut from.
+ * @param scale Integer units per inch of the scaled lengths.
+ * @param offcutThreshold Shortest leftover reported as a usable offcut, 0 to
+ * report none.
+ */
+static Solution buildSolution(const std::vector<long long>& cutLengths,
+                              const std::vector<IdRuns>& cutIds,
+                              const std::vector<int>& demand,
+                              bool coverDemand,
+                              const std::vector<HighsInt>& start,
+                              const std::vector<HighsInt>& index,
+                              const std::vector<double>& value,
+                              const std::vector<double>& colValue,
+                              const std::vector<int>& columnStock,
+                              const std::vector<StockType>& stock,
+                              double kerf, double scale,
+                              double offcutThreshold) {
+  const size_t numPatterns = start.size() - 1;
+  const HighsInt numLengths = cutLengths.size();
   Solution result;
+  result.lengths = cutLengths;
+  result.scale = scale;
+  result.cut_ids = cutIds;
+  result.stock_used.assign(stock.size(), 0);
+  double totalStockLength = 0.0;
   double totalUsedLengthPrecise = 0.0;
 
-  for (size_t i = 0; i < patterns.size(); i++) {
-    int numSticks = static_cast<int>(std::round(solution.col_value[i]));
+  std::vector<int> surplus(numLengths, 0);
+  if (coverDemand) {
+    for (HighsInt i = 0; i < numLengths; i++) {
+      surplus[i] = -demand[i];
+    }
+    for (size_t p = 0; p < numPatterns; p++) {
+      int numSticks = static_cast<int>(std::round(colValue[p]));
+      for (HighsInt k = start[p]; k < start[p + 1]; k++) {
+        if (index[k] < numLengths) {
+          surplus[index[k]] += static_cast<int>(value[k]) * numSticks;
+        }
+      }
+    }
+  }
+
+  std::vector<std::pair<int, int>> layout;
+  for (size_t p = 0; p < numPatterns; p++) {
+    int numSticks = static_cast<int>(std::round(colValue[p]));
     if (numSticks == 0)
       continue;
+    const StockType& type = stock[columnStock[p]];
 
-    const auto& pattern = patterns[i];
-    double preciseUsedLen = 0.0;
-
-    std::vector<Cut> cutSlice;
-    for (long long scaled_len : pattern) {
-      double len = static_cast<double>(scaled_len) / PRECISION_SCALE;
-      cutSlice.push_back(Cut(len, 0));
-      preciseUsedLen += len;
-    }
-    // For n pieces, we need n-1 kerfs (between pieces, not after the last one)
-    if (cutSlice.size() > 0) {
-      preciseUsedLen += (cutSlice.size() - 1) * kerf;
-    }
+    for (int s = 0; s < numSticks;) {
+      layout.clear();
+      bool trimmed = false;
+      int pieces = 0;
+      double preciseUsedLen = 0.0;
+      for (HighsInt k = start[p]; k < start[p + 1]; k++) {
+        HighsInt i = index[k];
+        if (i >= numLengths)
+          continue;
+        int keep = static_cast<int>(value[k]);
+        if (surplus[i] > 0) {
+          int drop = std::min(keep, surplus[i]);
+          surplus[i] -= drop;
+          keep -= drop;
+          result.surplus_pieces += drop;
+          trimmed = true;
+        }
+        if (keep == 0)
+          continue;
+        layout.emplace_back(static_cast<int>(i), keep);
+        pieces += keep;
+        preciseUsedLen += keep * static_cast<double>(cutLengths[i]) / scale;
+      }
+      // Nothing was trimmed from this stick, so nothing will be from the
+      // rest of the pattern either and they all share its layout
+      int sticks = trimmed ? 1 : numSticks - s;
+      s += sticks;
+      if (pieces == 0)
+        continue;
+      // For n pieces, we need n-1 kerfs (between pieces, not after the last
+      // one)
+      preciseUsedLen += (pieces - 1) * kerf;
 
-    for (int s = 0; s < numSticks; s++) {
-      Stick stick;
-      stick.cuts = cutSlice;
-      stick.stock_len = stockLen;
-      stick.used_len = preciseUsedLen;
-      stick.waste_len = stockLen - preciseUsedLen;
-      result.sticks.push_back(stick);
+      if (!result.runs.empty() && result.runs.back().pieces == layout &&
+          result.runs.back().stock_type == columnStock[p]) {
+        result.runs.back().count += sticks;
+      } else {
+        StickRun run;
+        run.pieces = layout;
+        run.count = sticks;
+        run.stock_type = columnStock[p];
+        run.stock_len = type.length;
+        run.used_len = preciseUsedLen;
+        run.waste_len = type.length - preciseUsedLen;
+        run.remnant = type.remnant;
+        result.runs.push_back(std::move(run));
+      }
+      // The leftover is separated from the last piece by one more kerf
+      double offcut = type.length - preciseUsedLen - kerf;
+      if (offcutThreshold > 0 && offcut >= offcutThreshold) {
+        result.offcuts.insert(result.offcuts.end(), sticks, offcut);
+      }
+      result.num_sticks += sticks;
+      result.stock_used[columnStock[p]] += sticks;
+      result.total_cost += sticks * type.cost;
+      totalStockLength += sticks * type.length;
+      totalUsedLengthPrecise += sticks * preciseUsedLen;
     }
-    totalUsedLengthPrecise += preciseUsedLen * numSticks;
   }
 
-  result.num_sticks = result.sticks.size();
-  result.total_waste = result.num_sticks * stockLen - totalUsedLengthPrecise;
+  std::sort(result.offcuts.begin(), result.offcuts.end(),
+            std::greater<double>());
+  result.total_waste = totalStockLength - totalUsedLengthPrecise;
 
   return result;
 }
 
 /**
- * @brief Generates all possible cutting patterns using scaled integers.
+ * @brief Bounded knapsack used to price new columns.
  *
- * This function recursively finds all combinations of cuts that can fit onto a
- * single stock piece.  
- * */
-static std::vector<std::vector<long long>>
-generatePatterns(const std::vector<long long>& availableCuts,
-                 long long stockLen, long long kerf) {
-  std::set<long long> uniqueCutsSet(availableCuts.begin(), availableCuts.end());
-  std::vector<long long> uniqueCuts(uniqueCutsSet.begin(), uniqueCutsSet.end());
-  std::sort(uniqueCuts.rbegin(), uniqueCuts.rend());
-
-  std::vector<std::vector<long long>> patterns;
-  std::vector<long long> currentPattern;
-
-  std::function<void(int, long long)> findPatterns =
-      [&](int startIndex, long long remainingLen) {
-        // Add the current combination as a valid pattern *before* trying to add
-        // more
-        if (!currentPattern.empty()) {
-          patterns.push_back(currentPattern);
-        }
+ * Maximizes sum(dual[i] * a[i]) subject to sum(weight[i] * a[i]) <= capacity
+ * and a[i] <= bound[i] with a depth-first branch and bound. Items are visited
+ * in decreasing dual/weight ratio so the fractional bound prunes early.
+ */
+struct KnapsackPricer {
+  std::vector<long long> weight;
+  std::vector<double> value;
+  std::vector<int> bound;
+  std::vector<int> order;
 
-        // Try adding more cuts, starting from `startIndex` to avoid
-        // permutations
-        for (size_t i = startIndex; i < uniqueCuts.size(); i++) {
-          long long cutLength = uniqueCuts[i];
-          // For n pieces, we need n-1 kerfs (between pieces, not after the last one)
-          // First cut: no kerf needed yet. Subsequent cuts: need kerf + cut length
-          long long requiredSpace = cutLength + (currentPattern.empty() ? 0 : kerf);
-          if (remainingLen >= requiredSpace) {
-            currentPattern.push_back(cutLength);
-            findPatterns(i, remainingLen - requiredSpace);
-            currentPattern.pop_back(); // Backtrack for the next combination
-          }
-        }
-      };
+  std::vector<int> current;
+  std::vector<int> best;
+  double bestValue{0.0};
+  long long nodes{0};
+
+  // Cap on branch and bound nodes per pricing round; when it is hit the best
+  // column found so far is returned instead of the proven optimum
+  static constexpr long long kMaxNodes = 5000000;
+
+  void search(size_t k, long long remaining, double total) {
+    if (total > bestValue + PRICING_EPS) {
+      bestValue = total;
+      best = current;
+    }
+    if (k == order.size() || ++nodes > kMaxNodes)
+      return;
+
+    int item = order[k];
+    double ratio = value[item] / weight[item];
+    if (total + remaining * ratio <= bestValue + PRICING_EPS)
+      return;
+
+    long long fit = remaining / weight[item];
+    int maxCount = static_cast<int>(std::min<long long>(bound[item], fit));
+    for (int c = maxCount; c >= 0; c--) {
+      current[item] = c;
+      search(k + 1, remaining - c * weight[item], total + c * value[item]);
+    }
+    current[item] = 0;
+  }
+};
+
+
+/**
+ * @brief Builds pattern sets by Gilmore-Gomory column generation.
+ *
+ * Starts from one homogeneous pattern per length and stock type plus the
+ * layouts of the seed packing, then repeatedly solves the LP relaxation of
+ * the covering master and prices a new pattern for every stock type from the
+ * row duals with a bounded knapsack. A pattern on type k is attractive when
+ * its dual value exceeds the type's cost less the dual of its availability
+ * row. Stops once no type has a pattern with negative reduced cost, so the
+ * returned sets support an optimal LP and the final integer master can be
+ * solved over them.
+ *
+ * @param cutLengths Unique scaled cut lengths, descending (one master row
+ * each).
+ * @param demand Required quantity for each length.
+ * @param seed A feasible packing whose layouts keep a capped master feasible;
+ * it is not part of the result.
+ * @return Patterns over `cutLengths`, one set per stock type (empty for types
+ * with nothing available).
+ */
+static std::vector<PatternSet>
+generateColumns(const std::vector<long long>& cutLengths,
+                const std::vector<int>& demand,
+                const std::vector<StockOption>& stock, long long kerf,
+                const Packing& seed, int maxRounds,
+                std::chrono::steady_clock::time_point deadline) {
+  const size_t n = cutLengths.size();
+  const size_t numStock = stock.size();
+  std::vector<PatternSet> columns(numStock);
+
+  // n pieces need n-1 kerfs, so a pattern fits when the sum of
+  // (length + kerf) over its pieces is at most stock + kerf
+  std::vector<KnapsackPricer> pricers(numStock);
+  std::vector<HighsInt> availabilityRow(numStock, -1);
+  HighsInt numRows = n;
+  for (size_t t = 0; t < numStock; t++) {
+    columns[t].lengths = cutLengths;
+    if (stock[t].available == 0)
+      continue;
+    KnapsackPricer& pricer = pricers[t];
+    long long capacity = stock[t].length + kerf;
+    pricer.weight.resize(n);
+    pricer.bound.resize(n);
+    for (size_t i = 0; i < n; i++) {
+      pricer.weight[i] = cutLengths[i] + kerf;
+      long long fit = capacity / pricer.weight[i];
+      pricer.bound[i] = static_cast<int>(std::min<long long>(demand[i], fit));
+    }
+    if (stock[t].available > 0) {
+      availabilityRow[t] = numRows++;
+    }
+  }
 
-  // Initial call to start the recursion.
-  findPatterns(0, stockLen);
+  Highs highs;
+  highs.setOptionValue("output_flag", false);
+  HighsModel model;
+  model.lp_.num_row_ = numRows;
+  model.lp_.row_lower_.assign(numRows, 0.0);
+  model.lp_.row_upper_.assign(numRows, kHighsInf);
+  for (size_t i = 0; i < n; i++) {
+    model.lp_.row_lower_[i] = demand[i];
+  }
+  for (size_t t = 0; t < numStock; t++) {
+    if (availabilityRow[t] >= 0) {
+      model.lp_.row_upper_[availabilityRow[t]] = stock[t].available;
+    }
+  }
+  model.lp_.sense_ = ObjSense::kMinimize;
+  highs.passModel(std::move(model));
 
-  // Remove duplicate patterns
-  for (auto& p : patterns) {
-    std::sort(p.begin(), p.end());
+  // Adds a column to the master LP (with its availability entry) and, unless
+  // it only seeds the master, to the type's pattern set
+  std::vector<HighsInt> rowIndex;
+  std::vector<double> rowValue;
+  auto addColumn = [&](size_t t, const std::vector<int>& counts, bool keep) {
+    rowIndex.clear();
+    rowValue.clear();
+    for (size_t i = 0; i < n; i++) {
+      if (counts[i] > 0) {
+        rowIndex.push_back(i);
+        rowValue.push_back(counts[i]);
+      }
+    }
+    if (keep) {
+      columns[t].index.insert(columns[t].index.end(), rowIndex.begin(),
+                              rowIndex.end());
+      columns[t].value.insert(columns[t].value.end(), rowValue.begin(),
+                              rowValue.end());
+      columns[t].start.push_back(columns[t].index.size());
+    }
+    if (availabilityRow[t] >= 0) {
+      rowIndex.push_back(availabilityRow[t]);
+      rowValue.push_back(1.0);
+    }
+    highs.addCol(stock[t].cost, 0.0, kHighsInf, rowIndex.size(),
+                 rowIndex.data(), rowValue.data());
+  };
+
+  // Start with homogeneous patterns and the seed so the LP master is feasible
+  std::vector<std::set<std::vector<int>>> seen(numStock);
+  for (size_t t = 0; t < numStock; t++) {
+    if (stock[t].available == 0)
+      continue;
+    for (size_t i = 0; i < n; i++) {
+      if (pricers[t].bound[i] == 0)
+        continue;
+      std::vector<int> column(n, 0);
+      column[i] = pricers[t].bound[i];
+      seen[t].insert(column);
+      addColumn(t, column, true);
+    }
+  }
+  for (size_t p = 0; p < seed.patterns.size(); p++) {
+    std::vector<int> column(n, 0);
+    for (HighsInt k = seed.patterns.start[p]; k < seed.patterns.start[p + 1];
+         k++) {
+      column[seed.patterns.index[k]] = seed.patterns.value[k];
+    }
+    addColumn(seed.stock[p], column, false);
+  }
+
+  for (int round = 0; round < maxRounds; round++) {
+    if (std::chrono::steady_clock::now() >= deadline)
+      break;
+    highs.run();
+    if (highs.getModelStatus() != HighsModelStatus::kOptimal) {
+      std::cerr << "Column generation LP failed. Status: "
+                << highs.modelStatusToString(highs.getModelStatus())
+                << std::endl;
+      break;
+    }
+
+    const std::vector<double>& duals = highs.getSolution().row_dual;
+    bool added = false;
+    for (size_t t = 0; t < numStock; t++) {
+      if (stock[t].available == 0)
+        continue;
+      // Only lengths with a positive dual can make a column attractive
+      KnapsackPricer& pricer = pricers[t];
+      pricer.value.assign(duals.begin(), duals.begin() + n);
+      pricer.order.clear();
+      for (size_t i = 0; i < n; i++) {
+        if (pricer.value[i] > PRICING_EPS && pricer.bound[i] > 0)
+          pricer.order.push_back(i);
+      }
+      std::sort(pricer.order.begin(), pricer.order.end(), [&](int a, int b) {
+        return pricer.value[a] / pricer.weight[a] >
+               pricer.value[b] / pricer.weight[b];
+      });
+
+      // A column is worth adding only if its reduced cost
+      // cost - availabilityDual - value < 0
+      double threshold = stock[t].cost;
+      if (availabilityRow[t] >= 0) {
+        threshold -= duals[availabilityRow[t]];
+      }
+      pricer.current.assign(n, 0);
+      pricer.best.clear();
+      pricer.bestValue = threshold;
+      pricer.nodes = 0;
+      pricer.search(0, stock[t].length + kerf, 0.0);
+      if (pricer.best.empty() || !seen[t].insert(pricer.best).second)
+        continue;
+      addColumn(t, pricer.best, true);
+      added = true;
+    }
+    if (!added)
+      break;
   }
-  std::sort(patterns.begin(), patterns.end());
-  patterns.erase(std::unique(patterns.begin(), patterns.end()), patterns.end());
 
-  return patterns;
+  return columns;
 }
@@ -0,0 +1,100 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
+
+// First block of a thread's arena, and the most it keeps between requests;
+// a request needing more than that takes the rest from the heap each time
+const size_t SCRATCH_INITIAL_BYTES = 64 << 10;
+const size_t SCRATCH_MAX_KEPT_BYTES = 64 << 20;
+
+static std::atomic<size_t> g_reservedBytes{0};
+static std::atomic<uint64_t> g_resets{0};
+static std::atomic<uint64_t> g_overflows{0};
+
+// Heap upstream of an arena that tallies what it hands out, i.e. how far a
+// request went past the first block
+class OverflowResource : public std::pmr::memory_resource {
+public:
+  size_t bytes{0};
+
+private:
+  void* do_allocate(size_t size, size_t alignment) override {
+    bytes += size;
+    return std::pmr::new_delete_resource()->allocate(size, alignment);
+  }
+  void do_deallocate(void* p, size_t size, size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+  }
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+// One thread's arena and how deep in scopes the thread is
+struct ThreadArena {
+  std::unique_ptr<std::byte[]> block;
+  size_t size{0};
+  OverflowResource upstream;
+  std::optional<std::pmr::monotonic_buffer_resource> arena;
+  int depth{0};
+
+  ~ThreadArena() { g_reservedBytes -= size; }
+
+  // (Re)start the arena on a first block of at least `bytes`
+  void reset(size_t bytes) {
+    arena.reset();
+    upstream.bytes = 0;
+    if (bytes != size) {
+      g_reservedBytes += bytes;
+      g_reservedBytes -= size;
+      block.reset(new std::byte[bytes]);
+      size = bytes;
+    }
+    arena.emplace(block.get(), size, &upstream);
+  }
+};
+
+static ThreadArena& threadArena() {
+  thread_local ThreadArena local;
+  return local;
+}
+
+ScratchScope::ScratchScope() {
+  ThreadArena& local = threadArena();
+  if (local.depth++ == 0 && !local.arena) {
+    local.reset(SCRATCH_INITIAL_BYTES);
+  }
+}
+
+/**
+ * @brief Resets the thread's arena when the outermost scope ends.
+ *
+ * When the request spilled past the first block, the block is regrown to
+ * hold all of it next time (within SCRATCH_MAX_KEPT_BYTES), so the spill
+ * is paid once per thread rather than once per request.
+ */
+ScratchScope::~ScratchScope() {
+  ThreadArena& local = threadArena();
+  if (--local.depth > 0)
+    return;
+  g_resets++;
+  size_t needed = local.size + local.upstream.bytes;
+  if (local.upstream.bytes > 0) {
+    g_overflows++;
+  }
+  local.reset(std::min(needed, SCRATCH_MAX_KEPT_BYTES));
+}
+
+std::pmr::memory_resource* scratch() {
+  ThreadArena& local = threadArena();
+  if (local.depth == 0)
+    return std::pmr::new_delete_resource();
+  return &*local.arena;
+}
+
+ScratchStats scratchStats() {
+  return {g_reservedBytes.load(), g_resets.load(), g_overflows.load()};
+}
@@ -0,0 +1,332 @@
+// Command-line solver for cut list and job files, without the web server:
+//
+//   nesting-cli [--units mm] [--stock "24'"] [--kerf 1/8]
+//               [--mode column_generation]
+//               [--quality fast] [--time-limit 5000] [--saws 2] [--sticks]
+//               [--jobs N] [FILE|DIR|-]...
+//
+// Each file is one job: a JSON body as sent to /api/optimize, or a CSV/TSV
+// cut list solved on --stock. A directory stands for the .json, .csv, .tsv
+// and .txt files in it, and "-" (the default) reads one job from stdin.
+// Jobs run in parallel on N threads (all cores by default) and each prints
+// one JSON line on stdout, in the order the jobs were given: the file, job
+// name, solve time and solution, or the file and an error. With --sticks
+// the line also lists every stick, each cut with its cut list entry.
+
+#include "algorithm.h"
+#include "cut_list.h"
+#include "json.hpp"
+#include "json_writer.h"
+#include "parse.h"
+#include "report.h"
+#include "request.h"
+#include "sequence.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+// Settings from the command line. Stock and kerf apply to cut lists; units,
+// mode, quality, time limit and saws, when given, override those in JSON
+// jobs too.
+struct CliSettings {
+  std::string units;
+  std::string stock;
+  std::string kerf;
+  std::string mode;
+  std::string quality;
+  double timeLimitMs{-1}; // unset
+  int saws{0};            // unset
+  bool sticks{false};
+  RequestLimits limits;
+};
+
+static void usage() {
+  std::cerr << "usage: nesting-cli [--units in|mm] [--stock LENGTH] "
+               "[--kerf KERF] "
+               "[--mode exhaustive|column_generation] [--quality "
+               "optimal|fast] [--time-limit MS] [--saws N] [--sticks] "
+               "[--jobs N] [FILE|DIR|-]..."
+            << std::endl;
+}
+
+// The job files a command line names, directories expanded in name order
+static bool collectJobs(const std::vector<std::string>& paths,
+                        std::vector<std::string>& jobs) {
+  for (const auto& path : paths) {
+    std::error_code ec;
+    if (path == "-" || !fs::is_directory(path, ec)) {
+      jobs.push_back(path);
+      continue;
+    }
+    std::vector<std::string> files;
+    for (fs::directory_iterator it(path, ec), end; !ec && it != end;
+         it.increment(ec)) {
+      std::string ext = it->path().extension().string();
+      if (it->is_regular_file(ec) && (ext == ".json" || ext == ".csv" ||
+                                      ext == ".tsv" || ext == ".txt")) {
+        files.push_back(it->path().string());
+      }
+    }
+    if (ec) {
+      std::cerr << "Cannot read " << path << ": " << ec.message()
+                << std::endl;
+      return false;
+    }
+    std::sort(files.begin(), files.end());
+    jobs.insert(jobs.end(), files.begin(), files.end());
+  }
+  return true;
+}
+
+// Read one job file into a request, telling a JSON body from a cut list by
+// its first character. Cut lists are parsed as they are read.
+static bool readJob(const std::string& path, const CliSettings& settings,
+                    OptimizeRequest& request, std::string& error) {
+  FILE* file = path == "-" ? stdin : std::fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    error = std::string("Cannot open: ") + std::strerror(errno);
+    return false;
+  }
+  struct Closer {
+    FILE* file;
+    ~Closer() {
+      if (file != stdin)
+        std::fclose(file);
+    }
+  } closer{file};
+
+  char buffer[1 << 16];
+  size_t got = std::fread(buffer, 1, sizeof(buffer), file);
+  std::string_view head(buffer, got);
+  if (head.substr(0, 3) == "\xEF\xBB\xBF") {
+    head.remove_prefix(3);
+  }
+  size_t first = 0;
+  while (first < head.size() &&
+         std::isspace(static_cast<unsigned char>(head[first]))) {
+    first++;
+  }
+
+  try {
+    if (first < head.size() && head[first] == '{') {
+      std::string text(head);
+      while ((got = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        text.append(buffer, got);
+      }
+      json body = json::parse(text);
+      if (!settings.units.empty())
+        body["units"] = settings.units;
+      if (!settings.mode.empty())
+        body["mode"] = settings.mode;
+      if (!settings.quality.empty())
+        body["quality"] = settings.quality;
+      if (settings.timeLimitMs >= 0)
+        body["timeLimitMs"] = settings.timeLimitMs;
+      if (settings.saws > 0)
+        body["saws"] = settings.saws;
+      if (settings.sticks)
+        body["sticks"] = true;
+      if (!body.contains("kerf"))
+        body["kerf"] = "";
+      return parseOptimizeRequest(body, settings.limits, request, error);
+    }
+
+    if (settings.stock.empty()) {
+      error = "A cut list needs --stock";
+      return false;
+    }
+    json body;
+    if (path != "-")
+      body["jobName"] = fs::path(path).stem().string();
+    if (!settings.units.empty())
+      body["units"] = settings.units;
+    body["stockLength"] = settings.stock;
+    body["kerf"] = settings.kerf;
+    body["mode"] = settings.mode.empty() ? "exhaustive" : settings.mode;
+    body["quality"] = settings.quality.empty() ? "optimal" : settings.quality;
+    if (settings.timeLimitMs >= 0)
+      body["timeLimitMs"] = settings.timeLimitMs;
+    if (settings.saws > 0)
+      body["saws"] = settings.saws;
+    if (settings.sticks)
+      body["sticks"] = true;
+    if (!parseSolveSettings(body, settings.limits, request, error))
+      return false;
+
+    CutListReader reader(request.options.units);
+    bool ok = reader.feed(head);
+    while (ok && (got = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+      ok = reader.feed(std::string_view(buffer, got));
+    }
+    if (!ok || !reader.finish()) {
+      error = "Invalid cut list: " + reader.error();
+      return false;
+    }
+    for (const auto& item : reader.items()) {
+      if (!addCuts(request, item.length, item.quantity, item.label, error))
+        return false;
+    }
+    if (request.demands.empty()) {
+      error = "No valid cuts provided";
+      return false;
+    }
+    return true;
+  } catch (const std::exception& e) {
+    error = std::string("Invalid job: ") + e.what();
+    return false;
+  }
+}
+
+// Solve one job into its output line; false when it has no plan
+static bool solveJob(const std::string& path, const CliSettings& settings,
+                     std::string& line) {
+  JsonWriter out(line);
+  out.beginObject();
+  out.field("file", path);
+  OptimizeRequest request;
+  std::string error;
+  if (readJob(path, settings, request, error)) {
+    auto start = std::chrono::steady_clock::now();
+    Solution solution = optimizeCutting(request.demands, request.stock,
+                                        request.kerf, request.options);
+    std::chrono::duration<double> taken =
+        std::chrono::steady_clock::now() - start;
+    if (solution.status == "infeasible") {
+      error = "Not enough stock available for the cuts";
+    } else if (solution.num_sticks == 0) {
+      error = "No solution found";
+    } else {
+      out.field("jobName", request.jobName);
+      out.field("materialType", request.materialType);
+      out.field("seconds", taken.count());
+      if (request.saws.saws > 0) {
+        out.key("sawPlan");
+        writeSawPlan(out, planSaws(solution, request.saws));
+      }
+      if (request.sticks) {
+        out.key("sticks");
+        writeSticks(out, solution, solution.cut_ids, request.entries,
+                    request.options.units);
+      }
+      out.key("solution");
+      SolutionWriter(solution, request.stock, request.options.units)
+          .write(out);
+    }
+  }
+  if (!error.empty()) {
+    out.field("error", error);
+  }
+  out.endObject();
+  return error.empty();
+}
+
+int main(int argc, char* argv[]) {
+  CliSettings settings;
+  std::vector<std::string> paths;
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--units" && hasValue) {
+      settings.units = argv[++i];
+    } else if (arg == "--stock" && hasValue) {
+      settings.stock = argv[++i];
+    } else if (arg == "--kerf" && hasValue) {
+      settings.kerf = argv[++i];
+    } else if (arg == "--mode" && hasValue) {
+      settings.mode = argv[++i];
+    } else if (arg == "--quality" && hasValue) {
+      settings.quality = argv[++i];
+    } else if (arg == "--time-limit" && hasValue) {
+      settings.timeLimitMs = std::atof(argv[++i]);
+    } else if (arg == "--saws" && hasValue) {
+      settings.saws = std::max(0, std::atoi(argv[++i]));
+    } else if (arg == "--sticks") {
+      settings.sticks = true;
+    } else if (arg == "--jobs" && hasValue) {
+      threads = std::max(1, std::atoi(argv[++i]));
+    } else if (arg[0] != '-' || arg == "-") {
+      paths.push_back(arg);
+    } else {
+      usage();
+      return 1;
+    }
+  }
+  if (paths.empty()) {
+    paths.push_back("-");
+  }
+
+  std::vector<std::string> jobs;
+  if (!collectJobs(paths, jobs))
+    return 1;
+  if (jobs.empty()) {
+    std::cerr << "No job files found" << std::endl;
+    return 1;
+  }
+
+  // One solve per thread; the cores left over go to pattern enumeration
+  threads = std::min(threads, jobs.size());
+  settings.limits.enumerationThreads = static_cast<unsigned>(std::max<size_t>(
+      1, std::thread::hardware_concurrency() / threads));
+  settings.limits.maxQueueMs = 0;
+
+  // Lines are printed as soon as every job before them is done, so the
+  // output follows the input order whatever finishes first
+  std::vector<std::string> lines(jobs.size());
+  std::vector<char> finished(jobs.size(), 0);
+  std::atomic<size_t> nextJob{0};
+  std::atomic<size_t> failed{0};
+  size_t nextLine = 0;
+  std::mutex outputMutex;
+  auto worker = [&]() {
+    for (size_t j; (j = nextJob.fetch_add(1)) < jobs.size();) {
+      std::string line;
+      if (!solveJob(jobs[j], settings, line)) {
+        failed++;
+      }
+      std::lock_guard<std::mutex> lock(outputMutex);
+      lines[j] = std::move(line);
+      finished[j] = 1;
+      for (; nextLine < jobs.size() && finished[nextLine]; nextLine++) {
+        std::cout << lines[nextLine] << '\n';
+        lines[nextLine].clear();
+        lines[nextLine].shrink_to_fit();
+      }
+      std::cout.flush();
+    }
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threads; t++) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : workers) {
+    thread.join();
+  }
+  std::chrono::duration<double> taken =
+      std::chrono::steady_clock::now() - start;
+  if (jobs.size() > 1) {
+    std::cerr << "Solved " << jobs.size() - failed << " of " << jobs.size()
+              << " jobs in " << taken.count() << " s on " << threads
+              << " threads" << std::endl;
+  }
+  return failed > 0 ? 2 : 0;
+}
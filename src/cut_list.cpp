@@ -0,0 +1,242 @@
+#include "cut_list.h"
+#include "parse.h"
+#include "types.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <limits>
+
+// Longest line accepted. A line is the only part of the body held between
+// chunks, so this bounds what a body without newlines can make us buffer.
+const size_t MAX_LINE_BYTES = 4096;
+
+// Strip surrounding whitespace (and a stray carriage return) from a field
+static std::string_view trim(std::string_view text) {
+  while (!text.empty() && std::isspace(static_cast<unsigned char>(text[0]))) {
+    text.remove_prefix(1);
+  }
+  while (!text.empty() &&
+         std::isspace(static_cast<unsigned char>(text.back()))) {
+    text.remove_suffix(1);
+  }
+  return text;
+}
+
+// Case-insensitive match of a header cell against a list of names
+static bool namedAny(std::string_view cell,
+                     std::initializer_list<std::string_view> names) {
+  for (std::string_view name : names) {
+    if (cell.size() == name.size() &&
+        std::equal(cell.begin(), cell.end(), name.begin(), [](char a, char b) {
+          return std::tolower(static_cast<unsigned char>(a)) == b;
+        }))
+      return true;
+  }
+  return false;
+}
+
+bool CutListReader::fail(const std::string& what) {
+  error_ = "line " + std::to_string(lineNumber_) + ": " + what;
+  return false;
+}
+
+bool CutListReader::feed(std::string_view chunk) {
+  if (!error_.empty())
+    return false;
+
+  // Complete the line left over from the previous chunk first
+  if (!partial_.empty()) {
+    size_t newline = chunk.find('\n');
+    std::string_view rest = chunk.substr(0, newline);
+    if (partial_.size() + rest.size() > MAX_LINE_BYTES)
+      return failLongLine();
+    partial_.append(rest);
+    if (newline == std::string_view::npos)
+      return true;
+    chunk.remove_prefix(newline + 1);
+    if (!parseLine(partial_))
+      return false;
+    partial_.clear();
+  }
+
+  for (size_t newline; (newline = chunk.find('\n')) != std::string_view::npos;
+       chunk.remove_prefix(newline + 1)) {
+    if (!parseLine(chunk.substr(0, newline)))
+      return false;
+  }
+  if (chunk.size() > MAX_LINE_BYTES)
+    return failLongLine();
+  partial_.assign(chunk);
+  return true;
+}
+
+// Fail the line being read for its length, and drop what was kept of it
+bool CutListReader::failLongLine() {
+  lineNumber_++;
+  partial_.clear();
+  return fail("line longer than " + std::to_string(MAX_LINE_BYTES) +
+              " bytes");
+}
+
+bool CutListReader::finish() {
+  if (!error_.empty())
+    return false;
+  if (!partial_.empty()) {
+    if (!parseLine(partial_))
+      return false;
+    partial_.clear();
+  }
+  return true;
+}
+
+// A quoted field without its quotes, "" turned into ". Only fields that
+// contain an escaped quote are copied, into `scratch`.
+std::string_view CutListReader::unquote(std::string_view field,
+                                        std::string& scratch) {
+  field = trim(field);
+  if (field.size() < 2 || field.front() != '"' || field.back() != '"')
+    return field;
+  field = field.substr(1, field.size() - 2);
+  if (field.find("\"\"") == std::string_view::npos)
+    return field;
+  scratch.clear();
+  for (size_t i = 0; i < field.size(); i++) {
+    scratch.push_back(field[i]);
+    if (field[i] == '"' && i + 1 < field.size() && field[i + 1] == '"')
+      i++;
+  }
+  return scratch;
+}
+
+bool CutListReader::readHeader(const std::vector<std::string_view>& fields) {
+  lengthColumn_ = quantityColumn_ = labelColumn_ = -1;
+  for (size_t c = 0; c < fields.size(); c++) {
+    std::string_view cell = fields[c];
+    int column = static_cast<int>(c);
+    if (lengthColumn_ < 0 && namedAny(cell, {"length", "len", "size"})) {
+      lengthColumn_ = column;
+    } else if (quantityColumn_ < 0 &&
+               namedAny(cell, {"quantity", "qty", "count", "pieces"})) {
+      quantityColumn_ = column;
+    } else if (labelColumn_ < 0 &&
+               namedAny(cell, {"label", "part", "part number", "part_number",
+                               "partnumber", "name", "mark"})) {
+      labelColumn_ = column;
+    }
+  }
+  if (lengthColumn_ < 0)
+    return fail("header has no length column");
+  return true;
+}
+
+bool CutListReader::parseLine(std::string_view line) {
+  if (line.size() > MAX_LINE_BYTES)
+    return failLongLine();
+  lineNumber_++;
+  if (!sawFirstLine_ && line.substr(0, 3) == "\xEF\xBB\xBF") {
+    line.remove_prefix(3);
+  }
+  if (trim(line).empty())
+    return true;
+
+  if (!sawFirstLine_) {
+    if (line.find('\t') != std::string_view::npos) {
+      delimiter_ = '\t';
+    } else if (line.find(';') != std::string_view::npos &&
+               line.find(',') == std::string_view::npos) {
+      delimiter_ = ';';
+    }
+  }
+
+  // Split on the delimiter outside quoted fields, then strip the quotes. A
+  // quote only opens a quoted field at its start, so an unquoted 6" keeps
+  // its inch mark.
+  fields_.clear();
+  bool quoted = false;
+  bool atStart = true;
+  size_t begin = 0;
+  for (size_t i = 0; i <= line.size(); i++) {
+    if (i == line.size() || (!quoted && line[i] == delimiter_)) {
+      fields_.push_back(line.substr(begin, i - begin));
+      begin = i + 1;
+      atStart = true;
+    } else if (atStart) {
+      if (!std::isspace(static_cast<unsigned char>(line[i]))) {
+        atStart = false;
+        quoted = line[i] == '"';
+      }
+    } else if (quoted && line[i] == '"') {
+      if (i + 1 < line.size() && line[i + 1] == '"') {
+        i++;
+      } else {
+        quoted = false;
+      }
+    }
+  }
+  if (scratch_.size() < fields_.size()) {
+    scratch_.resize(fields_.size());
+  }
+  bool blank = true;
+  for (size_t c = 0; c < fields_.size(); c++) {
+    fields_[c] = unquote(fields_[c], scratch_[c]);
+    blank = blank && fields_[c].empty();
+  }
+  if (blank)
+    return true;
+
+  auto field = [this](int column) {
+    return column >= 0 && static_cast<size_t>(column) < fields_.size()
+               ? fields_[column]
+               : std::string_view();
+  };
+
+  double length;
+  std::string reason;
+  if (!sawFirstLine_) {
+    sawFirstLine_ = true;
+    if (!parseLength(field(lengthColumn_), units_, length, reason))
+      return readHeader(fields_);
+  } else if (!parseLength(field(lengthColumn_), units_, length, reason)) {
+    return fail("invalid length: " + reason);
+  }
+  if (length <= 0)
+    return fail("length must be positive");
+
+  long long quantity = 1;
+  std::string_view quantityText = field(quantityColumn_);
+  if (!quantityText.empty()) {
+    auto [end, ec] =
+        std::from_chars(quantityText.data(),
+                        quantityText.data() + quantityText.size(), quantity);
+    if (ec != std::errc() ||
+        end != quantityText.data() + quantityText.size() || quantity < 0)
+      return fail("invalid quantity \"" + std::string(quantityText) + "\"");
+  }
+  // Exports often carry rows with nothing left to cut
+  if (quantity == 0)
+    return true;
+
+  std::string_view label = field(labelColumn_);
+  long long scaled = std::llround(length * unitScale(units_));
+  key_.assign(std::to_string(scaled));
+  key_.push_back('\0');
+  key_.append(label);
+  auto it = itemIndex_.find(key_);
+  if (it != itemIndex_.end()) {
+    long long& total = items_[it->second].quantity;
+    if (quantity > std::numeric_limits<long long>::max() - total)
+      return fail("total quantity too large");
+    total += quantity;
+    return true;
+  }
+  itemIndex_.emplace(key_, items_.size());
+  CutListItem item;
+  item.length = length;
+  item.scaled = scaled;
+  item.quantity = quantity;
+  item.label.assign(label);
+  items_.push_back(std::move(item));
+  return true;
+}
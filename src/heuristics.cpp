@@ -0,0 +1,421 @@
+#include "heuristics.h"
+#include "arena.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <memory_resource>
+#include <set>
+#include <tuple>
+#include <utility>
+
+// A stick being packed: its (length index, pieces) runs
+using StickLayout = std::pmr::vector<std::pair<HighsInt, int>>;
+
+// n pieces need n-1 kerfs, so a stick holds a set of pieces when the sum of
+// (length + kerf) over them is at most stock + kerf
+
+int Packing::numSticks() const {
+  int total = 0;
+  for (int m : multiplicity) {
+    total += m;
+  }
+  return total;
+}
+
+double Packing::cost(const std::vector<StockOption>& stockTypes) const {
+  double total = 0.0;
+  for (size_t p = 0; p < multiplicity.size(); p++) {
+    total += multiplicity[p] * stockTypes[stock[p]].cost;
+  }
+  return total;
+}
+
+// Consecutive sticks with the same contents, so the same room left: the
+// first one's number, in the order the sticks were opened, and how many
+// there are. Greedy packing of one length touches a whole block at once,
+// as every stick in it takes the same pieces.
+struct StickBlock {
+  StickLayout layout;
+  long long room{0};
+  int first{0};
+  int count{0};
+};
+
+/**
+ * @brief Collapses blocks of sticks into distinct patterns.
+ *
+ * Blocks are filled in descending length order, so each one's pieces are
+ * already sorted by length index and identical layouts compare equal. The
+ * map and its keys live on the scratch arena, like the blocks.
+ */
+static Packing
+collectStickLayouts(const std::vector<long long>& lengths,
+                    const std::pmr::vector<StickBlock>& blocks) {
+  std::pmr::map<StickLayout, int> layouts(scratch());
+  for (const auto& block : blocks) {
+    if (block.count > 0)
+      layouts[block.layout] += block.count;
+  }
+
+  Packing packing;
+  packing.patterns.lengths = lengths;
+  for (const auto& [layout, count] : layouts) {
+    for (const auto& [index, pieces] : layout) {
+      packing.patterns.index.push_back(index);
+      packing.patterns.value.push_back(pieces);
+    }
+    packing.patterns.start.push_back(packing.patterns.index.size());
+    packing.multiplicity.push_back(count);
+    packing.stock.push_back(0);
+  }
+  return packing;
+}
+
+// Add `pieces` pieces of length index i to a layout's runs
+static void addPieces(StickLayout& layout, size_t i, int pieces) {
+  if (!layout.empty() && layout.back().first == static_cast<HighsInt>(i)) {
+    layout.back().second += pieces;
+  } else {
+    layout.emplace_back(static_cast<HighsInt>(i), pieces);
+  }
+}
+
+/**
+ * @brief Puts pieces of one length on a block, each stick in turn taking
+ * as many as it holds, as placing them one at a time would.
+ *
+ * When the pieces run out part way, the block splits into the sticks that
+ * took a full share, the one that took the rest and those that took none,
+ * in stick order; the first two are returned for the caller to place, and
+ * `block` keeps the untouched sticks (count 0 when there are none).
+ *
+ * @param remaining Pieces still to place, reduced by those placed.
+ */
+static std::pair<StickBlock, StickBlock>
+fillBlock(StickBlock& block, size_t i, long long weight, int& remaining) {
+  int each = static_cast<int>(
+      std::min<long long>(block.room / weight, remaining));
+  std::pair<StickBlock, StickBlock> split;
+  if (static_cast<long long>(each) * block.count <= remaining) {
+    addPieces(block.layout, i, each);
+    block.room -= each * weight;
+    remaining -= each * block.count;
+    return split;
+  }
+
+  int full = remaining / each;
+  int rest = remaining % each;
+  auto share = [&](int pieces, int count) {
+    StickBlock part{StickLayout(block.layout, scratch()),
+                    block.room - pieces * weight, block.first, count};
+    addPieces(part.layout, i, pieces);
+    block.first += count;
+    block.count -= count;
+    return part;
+  };
+  if (full > 0)
+    split.first = share(each, full);
+  if (rest > 0)
+    split.second = share(rest, 1);
+  remaining = 0;
+  return split;
+}
+
+// Open new sticks for the pieces of one length no open stick has room for,
+// each filled before the next is opened. A piece longer than the stock
+// still gets a stick to itself.
+static void openSticks(std::pmr::vector<StickBlock>& blocks, int& opened,
+                       size_t i, long long weight, long long capacity,
+                       int remaining) {
+  int each = static_cast<int>(
+      std::clamp<long long>(capacity / weight, 1, remaining));
+  int full = remaining / each;
+  int rest = remaining % each;
+  for (auto [pieces, count] : {std::pair<int, int>(each, full), {rest, 1}}) {
+    if (pieces == 0 || count == 0)
+      continue;
+    StickBlock block{StickLayout(scratch()), capacity - pieces * weight,
+                     opened, count};
+    addPieces(block.layout, i, pieces);
+    blocks.push_back(std::move(block));
+    opened += count;
+  }
+}
+
+// First Fit's blocks in stick order, in runs of about this many with the
+// most room left on any of them, so a sweep skips the runs that cannot take
+// a length
+const size_t BLOCKS_PER_RUN = 64;
+
+struct BlockRun {
+  std::pmr::vector<StickBlock> blocks;
+  long long maxRoom{0};
+
+  void updateRoom() {
+    maxRoom = 0;
+    for (const auto& block : blocks) {
+      maxRoom = std::max(maxRoom, block.room);
+    }
+  }
+};
+
+/**
+ * @brief First-Fit-Decreasing over the scaled pieces.
+ *
+ * Sticks are kept as blocks of identical ones in the order they were
+ * opened. Each length sweeps them from the first, skipping the runs with no
+ * room for it and filling every block that has, so what a length costs does
+ * not depend on how many pieces it has; it adds at most four blocks. The
+ * blocks are scratch.
+ */
+Packing firstFitDecreasing(const std::vector<long long>& lengths,
+                           const std::vector<int>& demand, long long stockLen,
+                           long long kerf) {
+  ScratchScope scope;
+  long long capacity = stockLen + kerf;
+  std::pmr::vector<BlockRun> runs(scratch());
+  int opened = 0;
+
+  for (size_t i = 0; i < lengths.size(); i++) {
+    long long weight = lengths[i] + kerf;
+    int remaining = demand[i];
+    for (size_t r = 0; r < runs.size() && remaining > 0; r++) {
+      if (runs[r].maxRoom < weight)
+        continue;
+      std::pmr::vector<StickBlock>& blocks = runs[r].blocks;
+      for (size_t b = 0; b < blocks.size() && remaining > 0; b++) {
+        if (blocks[b].room < weight)
+          continue;
+        auto [full, rest] = fillBlock(blocks[b], i, weight, remaining);
+        // The split sticks come before what is left of the block
+        size_t at = b;
+        for (StickBlock* part : {&full, &rest}) {
+          if (part->count > 0)
+            blocks.insert(blocks.begin() + at++, std::move(*part));
+        }
+        if (blocks[at].count == 0)
+          blocks.erase(blocks.begin() + at);
+      }
+      if (blocks.size() > 2 * BLOCKS_PER_RUN) {
+        BlockRun tail{std::pmr::vector<StickBlock>(
+                          std::make_move_iterator(blocks.begin() +
+                                                  BLOCKS_PER_RUN),
+                          std::make_move_iterator(blocks.end()), scratch()),
+                      0};
+        blocks.resize(BLOCKS_PER_RUN);
+        tail.updateRoom();
+        runs.insert(runs.begin() + r + 1, std::move(tail));
+      }
+      runs[r].updateRoom();
+    }
+    if (remaining > 0) {
+      if (runs.empty() || runs.back().blocks.size() >= BLOCKS_PER_RUN)
+        runs.push_back({std::pmr::vector<StickBlock>(scratch()), 0});
+      openSticks(runs.back().blocks, opened, i, weight, capacity, remaining);
+      runs.back().updateRoom();
+    }
+  }
+
+  std::pmr::vector<StickBlock> blocks(scratch());
+  for (auto& run : runs) {
+    std::move(run.blocks.begin(), run.blocks.end(),
+              std::back_inserter(blocks));
+  }
+  return collectStickLayouts(lengths, blocks);
+}
+
+/**
+ * @brief Best-Fit-Decreasing over the scaled pieces.
+ *
+ * Sticks are kept as blocks of identical ones, ordered by the room left on
+ * them and then by when they were opened, so the tightest sticks that
+ * still take a length are found in O(log blocks). Once a stick has taken a
+ * length it has less room than any other that takes it, so it goes on
+ * taking pieces until full: a whole block is filled in one step. The set
+ * and the blocks are scratch; a block keeps its set node as it fills, since
+ * the arena never hands a freed node out again.
+ */
+Packing bestFitDecreasing(const std::vector<long long>& lengths,
+                          const std::vector<int>& demand, long long stockLen,
+                          long long kerf) {
+  ScratchScope scope;
+  long long capacity = stockLen + kerf;
+  // (room, first stick) -> block
+  std::pmr::set<std::tuple<long long, int, size_t>> open(scratch());
+  std::pmr::vector<StickBlock> blocks(scratch());
+  int opened = 0;
+
+  for (size_t i = 0; i < lengths.size(); i++) {
+    long long weight = lengths[i] + kerf;
+    int remaining = demand[i];
+    while (remaining > 0) {
+      auto it = open.lower_bound({weight, 0, 0});
+      if (it == open.end()) {
+        size_t before = blocks.size();
+        openSticks(blocks, opened, i, weight, capacity, remaining);
+        for (size_t b = before; b < blocks.size(); b++) {
+          open.insert({blocks[b].room, blocks[b].first, b});
+        }
+        break;
+      }
+      auto node = open.extract(it);
+      StickBlock& block = blocks[std::get<2>(node.value())];
+      auto [full, rest] = fillBlock(block, i, weight, remaining);
+      for (StickBlock* part : {&full, &rest}) {
+        if (part->count > 0) {
+          open.insert({part->room, part->first, blocks.size()});
+          blocks.push_back(std::move(*part));
+        }
+      }
+      // `block` may have moved with the pushes above
+      const StickBlock& left = blocks[std::get<2>(node.value())];
+      if (left.count > 0) {
+        node.value() = {left.room, left.first, std::get<2>(node.value())};
+        open.insert(std::move(node));
+      }
+    }
+  }
+
+  return collectStickLayouts(lengths, blocks);
+}
+
+Packing assignStock(const Packing& packing, long long kerf,
+                    const std::vector<StockOption>& stockTypes) {
+  const PatternSet& layouts = packing.patterns;
+  std::vector<long long> load(layouts.size(), 0);
+  std::vector<size_t> order(layouts.size());
+  for (size_t p = 0; p < layouts.size(); p++) {
+    for (HighsInt k = layouts.start[p]; k < layouts.start[p + 1]; k++) {
+      load[p] += static_cast<long long>(layouts.value[k]) *
+                 (layouts.lengths[layouts.index[k]] + kerf);
+    }
+    order[p] = p;
+  }
+  std::sort(order.begin(), order.end(),
+            [&](size_t a, size_t b) { return load[a] > load[b]; });
+
+  // Cheapest first, shorter first among equal costs
+  std::vector<size_t> byCost(stockTypes.size());
+  for (size_t t = 0; t < stockTypes.size(); t++) {
+    byCost[t] = t;
+  }
+  std::sort(byCost.begin(), byCost.end(), [&](size_t a, size_t b) {
+    if (stockTypes[a].cost != stockTypes[b].cost)
+      return stockTypes[a].cost < stockTypes[b].cost;
+    return stockTypes[a].length < stockTypes[b].length;
+  });
+  std::vector<int> left(stockTypes.size());
+  for (size_t t = 0; t < stockTypes.size(); t++) {
+    left[t] = stockTypes[t].available;
+  }
+
+  Packing result;
+  result.patterns.lengths = layouts.lengths;
+  for (size_t p : order) {
+    int sticks = packing.multiplicity[p];
+    for (size_t t : byCost) {
+      if (sticks == 0)
+        break;
+      if (stockTypes[t].length + kerf < load[p] || left[t] == 0)
+        continue;
+      int take = left[t] < 0 ? sticks : std::min(sticks, left[t]);
+      if (left[t] > 0) {
+        left[t] -= take;
+      }
+      sticks -= take;
+
+      for (HighsInt k = layouts.start[p]; k < layouts.start[p + 1]; k++) {
+        result.patterns.index.push_back(layouts.index[k]);
+        result.patterns.value.push_back(layouts.value[k]);
+      }
+      result.patterns.start.push_back(result.patterns.index.size());
+      result.multiplicity.push_back(take);
+      result.stock.push_back(t);
+    }
+    if (sticks > 0)
+      return Packing();
+  }
+  return result;
+}
+
+/**
+ * @brief Greedy fill of the remnant sticks before any new stock is opened.
+ *
+ * Each remnant is packed in turn with as many of the longest remaining
+ * pieces as it holds. Consecutive remnants that end up with the same layout
+ * share a pattern, and a run of them is counted at once rather than packed
+ * one by one.
+ */
+Packing fillRemnants(const std::vector<long long>& lengths,
+                     std::vector<int>& demand, long long kerf,
+                     const std::vector<StockOption>& stockTypes) {
+  std::vector<size_t> remnants;
+  for (size_t t = 0; t < stockTypes.size(); t++) {
+    if (stockTypes[t].remnant && stockTypes[t].available > 0)
+      remnants.push_back(t);
+  }
+  std::sort(remnants.begin(), remnants.end(), [&](size_t a, size_t b) {
+    return stockTypes[a].length < stockTypes[b].length;
+  });
+
+  Packing packing;
+  packing.patterns.lengths = lengths;
+  std::vector<std::pair<HighsInt, int>> stick;
+  std::vector<std::pair<HighsInt, int>> previous;
+  for (size_t t : remnants) {
+    previous.clear();
+    for (int r = 0; r < stockTypes[t].available; r++) {
+      long long room = stockTypes[t].length + kerf;
+      stick.clear();
+      for (size_t i = 0; i < lengths.size(); i++) {
+        long long fit = room / (lengths[i] + kerf);
+        int take = static_cast<int>(std::min<long long>(demand[i], fit));
+        if (take == 0)
+          continue;
+        stick.emplace_back(static_cast<HighsInt>(i), take);
+        demand[i] -= take;
+        room -= take * (lengths[i] + kerf);
+      }
+      if (stick.empty())
+        break;
+
+      if (stick == previous) {
+        packing.multiplicity.back()++;
+      } else {
+        for (const auto& [index, pieces] : stick) {
+          packing.patterns.index.push_back(index);
+          packing.patterns.value.push_back(pieces);
+        }
+        packing.patterns.start.push_back(packing.patterns.index.size());
+        packing.multiplicity.push_back(1);
+        packing.stock.push_back(t);
+        previous = stick;
+      }
+
+      // The next remnants take the same pieces for as long as every length
+      // on this one has that many left, so they are counted in one step
+      int repeat = stockTypes[t].available - r - 1;
+      for (const auto& [index, pieces] : stick) {
+        repeat = std::min(repeat, demand[index] / pieces);
+      }
+      for (const auto& [index, pieces] : stick) {
+        demand[index] -= repeat * pieces;
+      }
+      packing.multiplicity.back() += repeat;
+      r += repeat;
+    }
+  }
+  return packing;
+}
+
+long long stickLowerBound(const std::vector<long long>& lengths,
+                          const std::vector<int>& demand, long long stockLen,
+                          long long kerf) {
+  long long capacity = stockLen + kerf;
+  long long total = 0;
+  for (size_t i = 0; i < lengths.size(); i++) {
+    total += (lengths[i] + kerf) * demand[i];
+  }
+  return (total + capacity - 1) / capacity;
+}
@@ -0,0 +1,132 @@
+#include "job_store.h"
+
+#include <cstdio>
+#include <utility>
+
+const char* jobStateName(JobState state) {
+  switch (state) {
+    case JobState::Queued: return "queued";
+    case JobState::Running: return "running";
+    case JobState::Done: return "done";
+    case JobState::Failed: return "failed";
+    default: return "unknown";
+  }
+}
+
+void JobRecord::setRunning() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (state_ == JobState::Queued) {
+    state_ = JobState::Running;
+  }
+}
+
+void JobRecord::publish(const std::string& type, std::string data) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (type == "progress") {
+      progress_ = data;
+    }
+    events_.push_back({nextSeq_++, type, std::move(data)});
+    if (events_.size() > kMaxEvents) {
+      events_.pop_front();
+    }
+  }
+  changed_.notify_all();
+}
+
+void JobRecord::finish(JobState state, std::string result) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    state_ = state;
+    result_ = result;
+    finishedAt_ = Clock::now();
+    events_.push_back({nextSeq_++, jobStateName(state), std::move(result)});
+    if (events_.size() > kMaxEvents) {
+      events_.pop_front();
+    }
+  }
+  changed_.notify_all();
+}
+
+JobRecord::Snapshot JobRecord::snapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return {state_, progress_, result_};
+}
+
+bool JobRecord::finished() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return state_ == JobState::Done || state_ == JobState::Failed;
+}
+
+JobRecord::Clock::time_point JobRecord::finishedAt() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return finishedAt_;
+}
+
+std::vector<JobEvent> JobRecord::waitEvents(uint64_t afterSeq,
+                                            std::chrono::milliseconds timeout,
+                                            bool& complete) const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  changed_.wait_for(lock, timeout, [&] { return nextSeq_ - 1 > afterSeq; });
+
+  std::vector<JobEvent> events;
+  for (const auto& event : events_) {
+    if (event.seq > afterSeq)
+      events.push_back(event);
+  }
+  complete = state_ == JobState::Done || state_ == JobState::Failed;
+  return events;
+}
+
+JobStore::JobStore(size_t maxJobs, double ttlSeconds)
+    : maxJobs_(maxJobs),
+      ttl_(std::chrono::duration_cast<JobRecord::Clock::duration>(
+          std::chrono::duration<double>(ttlSeconds))),
+      random_(std::random_device{}()) {}
+
+std::shared_ptr<JobRecord> JobStore::create() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  prune();
+  if (jobs_.size() >= maxJobs_) {
+    // Make room by forgetting the job that finished longest ago
+    auto oldest = jobs_.end();
+    for (auto it = jobs_.begin(); it != jobs_.end(); ++it) {
+      if (it->second->finished() &&
+          (oldest == jobs_.end() ||
+           it->second->finishedAt() < oldest->second->finishedAt())) {
+        oldest = it;
+      }
+    }
+    if (oldest == jobs_.end())
+      return nullptr;
+    jobs_.erase(oldest);
+  }
+
+  char id[17];
+  do {
+    std::snprintf(id, sizeof(id), "%016llx",
+                  static_cast<unsigned long long>(random_()));
+  } while (jobs_.count(id));
+  auto record = std::make_shared<JobRecord>(id);
+  jobs_[id] = record;
+  return record;
+}
+
+std::shared_ptr<JobRecord> JobStore::find(const std::string& id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  prune();
+  auto it = jobs_.find(id);
+  return it == jobs_.end() ? nullptr : it->second;
+}
+
+// Drop finished jobs past their time-to-live; caller holds the lock
+void JobStore::prune() {
+  auto now = JobRecord::Clock::now();
+  for (auto it = jobs_.begin(); it != jobs_.end();) {
+    if (it->second->finished() && now - it->second->finishedAt() > ttl_) {
+      it = jobs_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
@@ -0,0 +1,141 @@
+#include "json_writer.h"
+
+#include <charconv>
+#include <cmath>
+
+void JsonWriter::separate() {
+  if (afterKey_) {
+    afterKey_ = false;
+    return;
+  }
+  if (!nonEmpty_.empty()) {
+    if (nonEmpty_.back())
+      out_ += ',';
+    nonEmpty_.back() = true;
+  }
+}
+
+void JsonWriter::beginObject() {
+  separate();
+  out_ += '{';
+  nonEmpty_.push_back(false);
+}
+
+void JsonWriter::endObject() {
+  out_ += '}';
+  nonEmpty_.pop_back();
+}
+
+void JsonWriter::beginArray() {
+  separate();
+  out_ += '[';
+  nonEmpty_.push_back(false);
+}
+
+void JsonWriter::endArray() {
+  out_ += ']';
+  nonEmpty_.pop_back();
+}
+
+void JsonWriter::key(std::string_view name) {
+  separate();
+  appendString(out_, name);
+  out_ += ':';
+  afterKey_ = true;
+}
+
+void JsonWriter::value(std::string_view text) {
+  separate();
+  appendString(out_, text);
+}
+
+void JsonWriter::value(double number) {
+  separate();
+  appendNumber(out_, number);
+}
+
+void JsonWriter::value(long long number) {
+  separate();
+  char text[24];
+  auto result = std::to_chars(text, text + sizeof(text), number);
+  out_.append(text, result.ptr);
+}
+
+void JsonWriter::value(size_t number) {
+  separate();
+  char text[24];
+  auto result = std::to_chars(text, text + sizeof(text), number);
+  out_.append(text, result.ptr);
+}
+
+void JsonWriter::value(bool flag) {
+  separate();
+  out_ += flag ? "true" : "false";
+}
+
+void JsonWriter::null() {
+  separate();
+  out_ += "null";
+}
+
+void JsonWriter::raw(std::string_view json) {
+  separate();
+  out_.append(json);
+}
+
+void JsonWriter::appendString(std::string& out, std::string_view text) {
+  static const char hex[] = "0123456789abcdef";
+  out += '"';
+  size_t plain = 0; // start of the run not yet copied
+  for (size_t i = 0; i < text.size(); i++) {
+    unsigned char c = static_cast<unsigned char>(text[i]);
+    if (c >= 0x20 && c != '"' && c != '\\')
+      continue;
+    out.append(text.data() + plain, i - plain);
+    plain = i + 1;
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    case '\b':
+      out += "\\b";
+      break;
+    case '\f':
+      out += "\\f";
+      break;
+    default:
+      out += "\\u00";
+      out += hex[c >> 4];
+      out += hex[c & 0xf];
+    }
+  }
+  out.append(text.data() + plain, text.size() - plain);
+  out += '"';
+}
+
+void JsonWriter::appendNumber(std::string& out, double number) {
+  if (!std::isfinite(number)) {
+    out += "null";
+    return;
+  }
+  char text[32];
+  auto result = std::to_chars(text, text + sizeof(text), number);
+  std::string_view digits(text, result.ptr - text);
+  out.append(digits);
+  // Keep integral doubles recognizable as such, like nlohmann::json
+  if (digits.find_first_of(".e") == std::string_view::npos) {
+    out += ".0";
+  }
+}
@@ -0,0 +1,279 @@
+#include "logger.h"
+
+#include "json.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstddef>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using json = nlohmann::json;
+
+// One log line before formatting: a message, or an HTTP request when
+// `method` is set
+struct LogRecord {
+  std::time_t timestamp{0};
+  Logger::Level level{Logger::INFO};
+  std::string message;
+  std::string method;
+  std::string path;
+  std::string remoteAddr;
+  std::string remotePort;
+  int status{0};
+  double durationMs{-1};
+};
+
+// Bounded multi-producer, single-consumer queue (Vyukov's sequence-number
+// ring). Each slot's sequence says whether it is free for the producer at
+// that position or holds a record for the consumer.
+class LogRing {
+public:
+  explicit LogRing(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    mask_ = size - 1;
+    slots_.reset(new Slot[size]);
+    for (size_t i = 0; i < size; i++) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // False when the ring is full
+  bool push(LogRecord&& record) {
+    size_t position = tail_.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+      slot = &slots_[position & mask_];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                  static_cast<std::ptrdiff_t>(position);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(position, position + 1,
+                                        std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    slot->record = std::move(record);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side only; false when nothing is ready
+  bool pop(LogRecord& record) {
+    Slot& slot = slots_[head_ & mask_];
+    if (slot.sequence.load(std::memory_order_acquire) != head_ + 1)
+      return false;
+    record = std::move(slot.record);
+    slot.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+    head_++;
+    return true;
+  }
+
+private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    LogRecord record;
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t mask_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+  alignas(64) size_t head_{0};
+};
+
+static std::atomic<int> g_threshold{Logger::INFO};
+static std::atomic<uint64_t> g_dropped{0};
+
+// The ring and writer once started; producers read the pointer and never
+// see it change while the writer runs
+static std::atomic<LogRing*> g_ring{nullptr};
+static std::unique_ptr<LogRing> g_ringOwner;
+static std::thread g_writer;
+static std::atomic<bool> g_stopping{false};
+static std::mutex g_wakeMutex;
+static std::condition_variable g_wake;
+// Serializes synchronous writes with each other
+static std::mutex g_syncMutex;
+
+// How long the writer sleeps when the ring is empty; lines queue up meanwhile
+// and go out in one write
+static constexpr auto kFlushInterval = std::chrono::milliseconds(20);
+
+static void format(const LogRecord& record, std::string& out) {
+  json line;
+  line["timestamp"] = record.timestamp;
+  if (record.method.empty()) {
+    line["level"] = Logger::levelToString(record.level);
+    line["message"] = record.message;
+  } else {
+    line["level"] = record.status >= 400 ? "ERROR" : "INFO";
+    line["type"] = "http_request";
+    line["method"] = record.method;
+    line["path"] = record.path;
+    line["status"] = record.status;
+    line["remote_addr"] = record.remoteAddr;
+    line["remote_port"] = record.remotePort;
+    if (record.durationMs >= 0) {
+      line["duration_ms"] = record.durationMs;
+    }
+  }
+  out += line.dump();
+  out += '\n';
+}
+
+static void writeOut(const std::string& text) {
+  if (text.empty())
+    return;
+  std::fwrite(text.data(), 1, text.size(), stdout);
+  std::fflush(stdout);
+}
+
+static void submit(LogRecord&& record) {
+  record.timestamp = std::time(nullptr);
+  LogRing* ring = g_ring.load(std::memory_order_acquire);
+  if (ring == nullptr) {
+    std::string text;
+    format(record, text);
+    std::lock_guard<std::mutex> lock(g_syncMutex);
+    writeOut(text);
+    return;
+  }
+  if (!ring->push(std::move(record))) {
+    g_dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+static void writerLoop(LogRing* ring) {
+  std::string batch;
+  LogRecord record;
+  uint64_t reportedDrops = 0;
+  for (;;) {
+    bool stopping = g_stopping.load(std::memory_order_acquire);
+    batch.clear();
+    while (ring->pop(record)) {
+      format(record, batch);
+    }
+    uint64_t drops = g_dropped.load(std::memory_order_relaxed);
+    if (drops != reportedDrops) {
+      LogRecord notice;
+      notice.timestamp = std::time(nullptr);
+      notice.level = Logger::WARN;
+      notice.message = "Log buffer full, dropped " +
+                       std::to_string(drops - reportedDrops) + " lines";
+      format(notice, batch);
+      reportedDrops = drops;
+    }
+    writeOut(batch);
+    if (stopping)
+      return;
+    std::unique_lock<std::mutex> lock(g_wakeMutex);
+    g_wake.wait_for(lock, kFlushInterval, [] {
+      return g_stopping.load(std::memory_order_acquire);
+    });
+  }
+}
+
+std::string Logger::levelToString(Level level) {
+  switch (level) {
+    case DEBUG: return "DEBUG";
+    case INFO: return "INFO";
+    case WARN: return "WARN";
+    case ERROR: return "ERROR";
+    default: return "UNKNOWN";
+  }
+}
+
+bool Logger::parseLevel(const std::string& name, Level& level) {
+  std::string upper = name;
+  std::transform(upper.begin(), upper.end(), upper.begin(), [](char c) {
+    return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+  });
+  for (Level candidate : {DEBUG, INFO, WARN, ERROR}) {
+    if (upper == levelToString(candidate)) {
+      level = candidate;
+      return true;
+    }
+  }
+  if (upper == "WARNING") {
+    level = WARN;
+    return true;
+  }
+  return false;
+}
+
+void Logger::setLevel(Level level) {
+  g_threshold.store(level, std::memory_order_relaxed);
+}
+
+bool Logger::enabled(Level level) {
+  return level >= g_threshold.load(std::memory_order_relaxed);
+}
+
+void Logger::log(Level level, std::string message) {
+  if (!enabled(level))
+    return;
+  LogRecord record;
+  record.level = level;
+  record.message = std::move(message);
+  submit(std::move(record));
+}
+
+void Logger::logRequest(const std::string& method, const std::string& path,
+                        int status, const std::string& remoteAddr,
+                        const std::string& remotePort, double duration_ms) {
+  if (path == "/" || path == "/api/health") {
+    return;
+  }
+  if (!enabled(status >= 400 ? ERROR : INFO))
+    return;
+
+  LogRecord record;
+  record.method = method;
+  record.path = path;
+  record.status = status;
+  record.remoteAddr = remoteAddr;
+  record.remotePort = remotePort;
+  record.durationMs = duration_ms;
+  submit(std::move(record));
+}
+
+void Logger::start(size_t capacity) {
+  if (g_ringOwner)
+    return;
+  g_ringOwner = std::make_unique<LogRing>(std::max<size_t>(capacity, 2));
+  g_stopping.store(false, std::memory_order_release);
+  g_writer = std::thread(writerLoop, g_ringOwner.get());
+  g_ring.store(g_ringOwner.get(), std::memory_order_release);
+}
+
+void Logger::stop() {
+  if (!g_ringOwner)
+    return;
+  // New records go out synchronously from here; the writer drains what is
+  // already queued. A producer that read the pointer just before this may
+  // still be pushing, so the ring itself is kept until exit.
+  g_ring.store(nullptr, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(g_wakeMutex);
+    g_stopping.store(true, std::memory_order_release);
+  }
+  g_wake.notify_one();
+  g_writer.join();
+}
+
+uint64_t Logger::dropped() {
+  return g_dropped.load(std::memory_order_relaxed);
+}
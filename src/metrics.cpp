@@ -0,0 +1,164 @@
+#include "metrics.h"
+
+#include <cmath>
+#include <cstdio>
+
+// Shortest faithful text for a sample value, as Prometheus spells it
+static std::string formatValue(double value) {
+  if (std::isinf(value))
+    return value > 0 ? "+Inf" : "-Inf";
+  if (std::isnan(value))
+    return "NaN";
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.9g", value);
+  return text;
+}
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)),
+      counts_(new std::atomic<uint64_t>[bounds_.size() + 1]) {
+  for (size_t b = 0; b <= bounds_.size(); b++) {
+    counts_[b].store(0, std::memory_order_relaxed);
+  }
+}
+
+void Histogram::observe(double value) {
+  size_t bucket = 0;
+  while (bucket < bounds_.size() && value > bounds_[bucket]) {
+    bucket++;
+  }
+  counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+  double sum = sum_.load(std::memory_order_relaxed);
+  while (!sum_.compare_exchange_weak(sum, sum + value,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+void Histogram::write(std::string& out, const std::string& name,
+                      const std::string& labels) const {
+  std::string prefix = labels.empty() ? "" : labels + ",";
+  uint64_t cumulative = 0;
+  for (size_t b = 0; b <= bounds_.size(); b++) {
+    cumulative += counts_[b].load(std::memory_order_relaxed);
+    double bound = b < bounds_.size() ? bounds_[b] : INFINITY;
+    writeSample(out, name + "_bucket",
+                prefix + "le=\"" + formatValue(bound) + "\"",
+                static_cast<double>(cumulative));
+  }
+  writeSample(out, name + "_sum", labels,
+              sum_.load(std::memory_order_relaxed));
+  writeSample(out, name + "_count", labels, static_cast<double>(cumulative));
+}
+
+std::vector<double> exponentialBuckets(double start, double factor,
+                                       size_t count) {
+  std::vector<double> bounds;
+  bounds.reserve(count);
+  for (double bound = start; bounds.size() < count; bound *= factor) {
+    bounds.push_back(bound);
+  }
+  return bounds;
+}
+
+const char* phaseName(Phase phase) {
+  switch (phase) {
+  case Phase::JsonParse:
+    return "json_parse";
+  case Phase::LengthParse:
+    return "length_parse";
+  case Phase::Heuristics:
+    return "heuristics";
+  case Phase::Patterns:
+    return "patterns";
+  case Phase::ModelBuild:
+    return "model_build";
+  case Phase::MipSolve:
+    return "mip_solve";
+  case Phase::Grouping:
+    return "grouping";
+  case Phase::Sequencing:
+    return "sequencing";
+  case Phase::Serialize:
+    return "serialize";
+  }
+  return "unknown";
+}
+
+// Phases run from microseconds (parsing) to the solver's time limit, so
+// their buckets go from 10 us to about 170 s in steps of 4x; whole requests
+// from 1 ms to about 130 s in steps of 2x
+RequestMetrics::RequestMetrics()
+    : requestSeconds_(exponentialBuckets(1e-3, 2.0, 18)),
+      columns_(exponentialBuckets(1, 4.0, 12)),
+      nodes_(exponentialBuckets(1, 4.0, 12)),
+      iterations_(exponentialBuckets(1, 4.0, 14)),
+      gap_({0.0, 1e-6, 1e-4, 1e-3, 0.01, 0.05, 0.1, 0.25}) {
+  for (auto& phase : phases_) {
+    phase = std::make_unique<Histogram>(exponentialBuckets(1e-5, 4.0, 13));
+  }
+}
+
+void RequestMetrics::observePhase(Phase phase, double seconds) {
+  phases_[static_cast<size_t>(phase)]->observe(seconds);
+}
+
+void RequestMetrics::observeSolve(const Solution& solution) {
+  const SolveStats& stats = solution.stats;
+  observePhase(Phase::Heuristics, stats.heuristic_ms / 1000.0);
+  if (stats.pattern_ms > 0) {
+    observePhase(Phase::Patterns, stats.pattern_ms / 1000.0);
+  }
+  // Answers that never reached the MIP have no model to record
+  if (stats.columns == 0)
+    return;
+  observePhase(Phase::ModelBuild, stats.model_ms / 1000.0);
+  observePhase(Phase::MipSolve, stats.mip_ms / 1000.0);
+  columns_.observe(static_cast<double>(stats.columns));
+  nodes_.observe(static_cast<double>(stats.mip_nodes));
+  iterations_.observe(static_cast<double>(stats.lp_iterations));
+  gap_.observe(solution.mip_gap);
+}
+
+void RequestMetrics::observeRequest(double seconds) {
+  requestSeconds_.observe(seconds);
+}
+
+void RequestMetrics::write(std::string& out) const {
+  writeMetricHeader(out, "nesting_phase_seconds", "histogram",
+                    "Time spent in each phase of handling a request");
+  for (size_t p = 0; p < kNumPhases; p++) {
+    phases_[p]->write(out, "nesting_phase_seconds",
+                      std::string("phase=\"") +
+                          phaseName(static_cast<Phase>(p)) + "\"");
+  }
+  writeMetricHeader(out, "nesting_request_seconds", "histogram",
+                    "Wall time of optimize requests, cache hits included");
+  requestSeconds_.write(out, "nesting_request_seconds", "");
+  writeMetricHeader(out, "nesting_mip_columns", "histogram",
+                    "Patterns (columns) in each MIP solved");
+  columns_.write(out, "nesting_mip_columns", "");
+  writeMetricHeader(out, "nesting_mip_nodes", "histogram",
+                    "Branch-and-bound nodes per MIP solve");
+  nodes_.write(out, "nesting_mip_nodes", "");
+  writeMetricHeader(out, "nesting_lp_iterations", "histogram",
+                    "Simplex iterations per MIP solve");
+  iterations_.write(out, "nesting_lp_iterations", "");
+  writeMetricHeader(out, "nesting_mip_gap", "histogram",
+                    "Relative gap of the plans returned by the MIP");
+  gap_.write(out, "nesting_mip_gap", "");
+}
+
+void writeMetricHeader(std::string& out, const std::string& name,
+                       const std::string& type, const std::string& help) {
+  out += "# HELP " + name + " " + help + "\n";
+  out += "# TYPE " + name + " " + type + "\n";
+}
+
+void writeSample(std::string& out, const std::string& name,
+                 const std::string& labels, double value) {
+  out += name;
+  if (!labels.empty()) {
+    out += "{" + labels + "}";
+  }
+  out += " " + formatValue(value) + "\n";
+}
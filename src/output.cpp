@@ -1,12 +1,17 @@
 #include "output.h"
+#include "arena.h"
+#include "cache.h"
 #include "utils.h"
 
 #include <algorithm>
 #include <cmath>
+#include <functional>
 #include <iomanip>
 #include <iostream>
-#include <map>
+#include <memory_resource>
 #include <sstream>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 /**
@@ -42,59 +47,169 @@ std::string toFraction(double value) {
 }
 
 /**
- * @brief Helper function to group identical sticks into patterns for cleaner
- * output. This is used by the web_server to format the solution for JSON
- * response.
+ * @brief Expands the runs of a solution into individual sticks.
  *
- * @param sticks A vector of Stick objects representing the cutting solution.
- * @return A vector of Pattern objects, where identical sticks are grouped.
+ * Each length's ids are handed out in order as its pieces are laid out, so
+ * the same solution always expands to the same id on the same stick.
+ *
+ * @param solution The cutting solution.
+ * @param ids Id runs per length of the solution; a length without any, or
+ * one whose runs are used up, gets id 0.
+ */
+std::vector<Stick> expandSticks(const Solution& solution,
+                                const std::vector<IdRuns>& ids) {
+  std::vector<Stick> sticks;
+  sticks.reserve(solution.num_sticks);
+  // Position in each length's id runs: the run, and pieces taken from it
+  std::vector<std::pair<size_t, int>> next(solution.lengths.size(), {0, 0});
+  auto takeId = [&](int i) {
+    if (static_cast<size_t>(i) >= ids.size())
+      return 0;
+    const IdRuns& runs = ids[i];
+    auto& [run, taken] = next[i];
+    while (run < runs.size() && taken == runs[run].second) {
+      run++;
+      taken = 0;
+    }
+    if (run == runs.size())
+      return 0;
+    taken++;
+    return runs[run].first;
+  };
+
+  for (const auto& run : solution.runs) {
+    for (int s = 0; s < run.count; s++) {
+      Stick stick;
+      stick.stock_len = run.stock_len;
+      stick.used_len = run.used_len;
+      stick.waste_len = run.waste_len;
+      stick.remnant = run.remnant;
+      for (const auto& [i, quantity] : run.pieces) {
+        double len = solution.lengths[i] / solution.scale;
+        for (int c = 0; c < quantity; c++) {
+          stick.cuts.push_back(Cut(len, takeId(i)));
+        }
+      }
+      sticks.push_back(std::move(stick));
+    }
+  }
+  return sticks;
+}
+
+/**
+ * @brief Expands a solution into sticks with its own cut ids.
+ */
+std::vector<Stick> expandSticks(const Solution& solution) {
+  return expandSticks(solution, solution.cut_ids);
+}
+
+/**
+ * @brief Lays a request's demands out as id runs over a solution's lengths.
+ *
+ * Each demand goes to the length it rounds to in the solution's units, in
+ * request order, exactly as the solver builds Solution::cut_ids, so a
+ * solution solved for an identical job expands with this request's ids.
+ *
+ * @param solution The cutting solution, with its lengths longest first.
+ * @param demands The request's demands; their index is the id.
+ * @return One set of (id, pieces) runs per length of the solution.
  */
-std::vector<Pattern> groupPatterns(const std::vector<Stick>& sticks) {
-  std::map<std::string, Pattern> patternMap;
+std::vector<IdRuns> demandIds(const Solution& solution,
+                              const std::vector<Demand>& demands) {
+  const std::vector<long long>& lengths = solution.lengths;
+  std::vector<IdRuns> ids(lengths.size());
+  for (size_t k = 0; k < demands.size(); k++) {
+    if (demands[k].quantity <= 0)
+      continue;
+    long long len =
+        static_cast<long long>(std::round(demands[k].length * solution.scale));
+    auto it = std::lower_bound(lengths.begin(), lengths.end(), len,
+                               std::greater<long long>());
+    if (it == lengths.end() || *it != len)
+      continue;
+    ids[it - lengths.begin()].emplace_back(static_cast<int>(k),
+                                           demands[k].quantity);
+  }
+  return ids;
+}
 
-  for (const auto& stick : sticks) {
-    std::vector<double> lengths;
-    for (const auto& cut : stick.cuts) {
-      lengths.push_back(cut.length);
+/**
+ * @brief Groups the runs of a solution by cutting pattern.
+ *
+ * Runs are keyed on their stock type and (length index, quantity) layout,
+ * which already identify the pattern in the solver's own integer terms, so
+ * no lengths are formatted or compared as doubles. Separate runs only share
+ * a key when the same layout came out of different columns or parts. The
+ * keys and the table live on the scratch arena, so a plan with thousands of
+ * layouts costs no heap allocations beyond the returned groups.
+ *
+ * @param solution The cutting solution.
+ * @return One group per distinct pattern, most-used first, then fullest
+ * first.
+ */
+std::vector<RunGroup> groupRuns(const Solution& solution) {
+  using Layout = std::pmr::vector<long long>;
+  struct LayoutHash {
+    size_t operator()(const Layout& words) const {
+      return hashWords(words.data(), words.size());
     }
-    std::sort(lengths.begin(), lengths.end(), std::greater<double>());
+  };
+  ScratchScope scope;
+  std::pmr::unordered_map<Layout, size_t, LayoutHash> byLayout(scratch());
+  std::vector<RunGroup> groups;
+  byLayout.reserve(solution.runs.size());
 
-    std::stringstream key_ss;
-    for (size_t i = 0; i < lengths.size(); i++) {
-      if (i > 0)
-        key_ss << ",";
-      // Use fixed precision for key to avoid floating point inconsistencies
-      key_ss << std::fixed << std::setprecision(5) << lengths[i];
+  for (size_t r = 0; r < solution.runs.size(); r++) {
+    const StickRun& run = solution.runs[r];
+    Layout key(scratch());
+    key.reserve(2 * run.pieces.size() + 1);
+    key.push_back(run.stock_type);
+    for (const auto& [i, quantity] : run.pieces) {
+      key.push_back(i);
+      key.push_back(quantity);
     }
-    std::string key = key_ss.str();
 
-    auto it = patternMap.find(key);
-    if (it != patternMap.end()) {
-      it->second.count++;
+    auto [it, inserted] = byLayout.emplace(std::move(key), groups.size());
+    if (inserted) {
+      groups.push_back({r, run.count});
     } else {
-      Pattern p;
-      p.cuts = stick.cuts;
-      std::sort(p.cuts.begin(), p.cuts.end(),
-                [](const Cut& a, const Cut& b) { return a.length > b.length; });
-      p.count = 1;
-      p.used_len = stick.used_len;
-      p.waste_len = stick.waste_len;
-      patternMap[key] = p;
+      groups[it->second].count += run.count;
     }
   }
 
-  std::vector<Pattern> patterns;
-  for (const auto& [key, p] : patternMap) {
-    patterns.push_back(p);
-  }
+  std::stable_sort(groups.begin(), groups.end(),
+                   [&](const RunGroup& a, const RunGroup& b) {
+                     if (a.count != b.count) {
+                       return a.count > b.count;
+                     }
+                     return solution.runs[a.run].used_len >
+                            solution.runs[b.run].used_len;
+                   });
 
-  std::sort(patterns.begin(), patterns.end(),
-            [](const Pattern& a, const Pattern& b) {
-              if (a.count != b.count) {
-                return a.count > b.count;
-              }
-              return a.used_len > b.used_len;
-            });
+  return groups;
+}
 
+/**
+ * @brief Groups the runs of a solution into patterns for cleaner output.
+ *
+ * @param solution The cutting solution.
+ * @return Distinct patterns, in groupRuns order.
+ */
+std::vector<Pattern> groupPatterns(const Solution& solution) {
+  std::vector<Pattern> patterns;
+  for (const RunGroup& group : groupRuns(solution)) {
+    const StickRun& run = solution.runs[group.run];
+    Pattern p;
+    for (const auto& [i, quantity] : run.pieces) {
+      p.cuts.insert(p.cuts.end(), quantity,
+                    Cut(solution.lengths[i] / solution.scale, 0));
+    }
+    p.count = group.count;
+    p.stock_len = run.stock_len;
+    p.remnant = run.remnant;
+    p.used_len = run.used_len;
+    p.waste_len = run.waste_len;
+    patterns.push_back(std::move(p));
+  }
   return patterns;
 }
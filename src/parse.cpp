@@ -2,56 +2,104 @@
 #include "utils.h"
 
 #include <cctype>
+#include <charconv>
 #include <cmath>
-#include <iostream>
-#include <regex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 
-/**
- * @brief Parses a string representing a fraction (e.g., "1/2") or a decimal
- * (e.g., "0.5").
- * @param s The input string.
- * @return The parsed value as a double. Returns 0.0 on failure.
- */
-double parseFraction(const std::string& s) {
-  std::string trimmed = std::regex_replace(s, std::regex("^\\s+|\\s+$"), "");
-  if (trimmed.empty())
-    return 0.0;
-
-  // Check for a fraction format like "numerator / denominator"
-  if (trimmed.find('/') != std::string::npos) {
-    std::regex re(R"(\s*(\d+(?:\.\d+)?)\s*\/\s*(\d+(?:\.\d+)?)\s*)");
-    std::smatch matches;
-    if (std::regex_match(trimmed, matches, re)) {
-      try {
-        double num = std::stod(matches[1].str());
-        double den = std::stod(matches[2].str());
-        if (den != 0) {
-          return num / den;
-        }
-      } catch (const std::exception&) {
-        return 0.0;
-      }
+// Cursor over the text of one length. Every method that can fail records
+// why in `error` and returns false.
+struct LengthScanner {
+  std::string_view text;
+  std::string& error;
+  size_t pos{0};
+
+  LengthScanner(std::string_view text_, std::string& error_)
+      : text(text_), error(error_) {}
+
+  bool atEnd() const { return pos == text.size(); }
+
+  void skipSpace() {
+    while (pos < text.size() &&
+           std::isspace(static_cast<unsigned char>(text[pos]))) {
+      pos++;
     }
-  } else {
-    // If not a fraction, try to parse as a simple number
-    try {
-      size_t pos;
-      double val = std::stod(trimmed, &pos);
-      // Ensure the whole string was consumed to avoid partial matches
-      if (pos == trimmed.length()) {
-        return val;
-      }
-    } catch (const std::exception&) {
-      return 0.0;
+  }
+
+  bool accept(char c) {
+    if (pos < text.size() && text[pos] == c) {
+      pos++;
+      return true;
     }
+    return false;
+  }
+
+  bool fail(const std::string& what) {
+    error = what + " at position " + std::to_string(pos + 1) + " in \"" +
+            std::string(text) + "\"";
+    return false;
   }
-  return 0.0; // Return 0.0 on any parsing failure
+
+  // Unsigned decimal: digits with an optional fractional part, no exponent
+  bool number(double& value) {
+    if (atEnd() || !(std::isdigit(static_cast<unsigned char>(text[pos])) ||
+                     text[pos] == '.'))
+      return fail("expected a number");
+    const char* first = text.data() + pos;
+    auto [last, ec] = std::from_chars(first, text.data() + text.size(), value,
+                                      std::chars_format::fixed);
+    if (ec != std::errc())
+      return fail("expected a number");
+    pos += last - first;
+    return true;
+  }
+
+  // A number, or a fraction "a/b" when `isFraction` comes back true
+  bool value(double& result, bool& isFraction) {
+    if (!number(result))
+      return false;
+    size_t afterNumber = pos;
+    skipSpace();
+    isFraction = accept('/');
+    if (!isFraction) {
+      pos = afterNumber;
+      return true;
+    }
+    skipSpace();
+    double denominator;
+    if (!number(denominator))
+      return false;
+    if (denominator == 0)
+      return fail("zero denominator");
+    result /= denominator;
+    return true;
+  }
+};
+
+/**
+ * @brief Parses a fraction (e.g., "1/2") or a decimal (e.g., "0.5").
+ * @param s The input text; surrounding whitespace is ignored.
+ * @param value Receives the parsed value.
+ * @param error Receives the reason when the text is not a number.
+ * @return Whether the text parsed.
+ */
+bool parseFraction(std::string_view s, double& value, std::string& error) {
+  LengthScanner in(s, error);
+  bool isFraction;
+  in.skipSpace();
+  if (in.atEnd())
+    return in.fail("empty value");
+  if (!in.value(value, isFraction))
+    return false;
+  in.skipSpace();
+  if (!in.atEnd())
+    return in.fail(std::string("unexpected '") + s[in.pos] + "'");
+  return true;
 }
 
 /**
- * @brief Parses various length formats into inches as a double.
+ * @brief Parses various length formats into inches in a single pass.
  *
  * Handles formats like:
  * - "24'" (24 feet)
@@ -63,93 +111,70 @@ double parseFraction(const std::string& s) {
  * - "110 1/8" (110 and 1/8 inches)
  * - "110.125" (decimal inches)
  *
- * @param s The input string.
- * @return The total length in inches as a double.
+ * @param s The input text; surrounding whitespace is ignored.
+ * @param inches Receives the total length in inches.
+ * @param error Receives the reason when the text is not a length.
+ * @return Whether the text parsed.
  */
-double parseAdvancedLength(const std::string& s) {
-  std::string input = std::regex_replace(s, std::regex("^\\s+|\\s+$"), "");
-  if (input.empty())
-    return 0.0;
-
-  double total_inches = 0.0;
-
-  // First, check for feet marker (')
-  size_t feet_pos = input.find('\'');
-  if (feet_pos != std::string::npos) {
-    // Parse feet part
-    std::string feet_str = input.substr(0, feet_pos);
-    total_inches += parseFraction(feet_str) * 12.0;
-
-    // Get the remaining string after feet
-    input = input.substr(feet_pos + 1);
-    input = std::regex_replace(input, std::regex("^\\s+|\\s+$"), "");
-  }
-
-  // If nothing left after feet, we're done
-  if (input.empty())
-    return total_inches;
-
-  // Now we need to parse the inches part, which might be in various formats:
-  // - "6\"" (just inches)
-  // - "6\" 1/2" (inches followed by fraction)
-  // - "6 1/2\"" (mixed number with inch mark at end)
-  // - "6 1/2" (mixed number without inch mark)
-  // - "1/2" (just a fraction)
-
-  // Remove any trailing inch mark first to simplify parsing
-  if (!input.empty() && input.back() == '"') {
-    input.pop_back();
-    input = std::regex_replace(input, std::regex("^\\s+|\\s+$"), "");
-  }
-
-  // Check if there's an inch mark in the middle (like "6\" 1/2")
-  size_t inch_mark_pos = input.find('"');
-  if (inch_mark_pos != std::string::npos) {
-    // Parse the part before the inch mark as whole inches
-    std::string before_mark = input.substr(0, inch_mark_pos);
-    total_inches += parseFraction(before_mark);
-
-    // Parse the part after the inch mark as additional fraction
-    std::string after_mark = input.substr(inch_mark_pos + 1);
-    after_mark = std::regex_replace(after_mark, std::regex("^\\s+|\\s+$"), "");
-    if (!after_mark.empty()) {
-      total_inches += parseFraction(after_mark);
-    }
-  } else {
-    // No inch mark in the middle, parse as mixed number or single value
-
-    // Look for a space that might indicate a mixed number (like "6 1/2")
-    // We need to be careful to identify the right space - the one before a
-    // fraction
-    size_t last_space = std::string::npos;
-    for (size_t i = 0; i < input.length(); ++i) {
-      if (std::isspace(input[i])) {
-        // Check if what follows looks like a fraction
-        size_t next_non_space = input.find_first_not_of(" \t", i);
-        if (next_non_space != std::string::npos) {
-          size_t slash_pos = input.find('/', next_non_space);
-          if (slash_pos != std::string::npos) {
-            // This space is before a fraction
-            last_space = i;
-          }
-        }
-      }
-    }
+bool parseLength(std::string_view s, double& inches, std::string& error) {
+  LengthScanner in(s, error);
+  double part;
+  bool isFraction;
+  in.skipSpace();
+  if (in.atEnd())
+    return in.fail("empty length");
+  if (!in.value(part, isFraction))
+    return false;
+  in.skipSpace();
 
-    if (last_space != std::string::npos) {
-      // Parse as mixed number
-      std::string whole_part = input.substr(0, last_space);
-      std::string frac_part = input.substr(last_space + 1);
+  inches = 0.0;
+  if (in.accept('\'')) {
+    inches = part * 12.0;
+    in.skipSpace();
+    if (in.atEnd())
+      return true;
+    if (!in.value(part, isFraction))
+      return false;
+    in.skipSpace();
+  }
+  inches += part;
 
-      total_inches += parseFraction(whole_part);
-      total_inches += parseFraction(frac_part);
-    } else {
-      // Parse as single value (either fraction or decimal)
-      total_inches += parseFraction(input);
+  // The inches may be followed by a fraction, either after an inch mark
+  // ("6\" 1/2") or as a mixed number ("6 1/2"), and close with a mark
+  bool marked = in.accept('"');
+  in.skipSpace();
+  if (!in.atEnd()) {
+    size_t fractionStart = in.pos;
+    if (!in.value(part, isFraction))
+      return false;
+    if (!marked && !isFraction) {
+      in.pos = fractionStart;
+      return in.fail("expected a fraction");
     }
+    inches += part;
+    in.skipSpace();
+    in.accept('"');
+    in.skipSpace();
   }
+  if (!in.atEnd())
+    return in.fail(std::string("unexpected '") + s[in.pos] + "'");
+  return true;
+}
 
-  return total_inches;
+double parseFraction(const std::string& s) {
+  double value;
+  std::string error;
+  if (!parseFraction(s, value, error))
+    throw std::invalid_argument(error);
+  return value;
+}
+
+double parseAdvancedLength(const std::string& s) {
+  double inches;
+  std::string error;
+  if (!parseLength(s, inches, error))
+    throw std::invalid_argument(error);
+  return inches;
 }
 
 /**
@@ -224,3 +249,87 @@ std::string prettyLen(double total_inches) {
 
   return ss.str();
 }
+
+/**
+ * @brief Parses a length given in a job's units into inches.
+ *
+ * Imperial text goes through parseLength. Millimetres are a plain decimal,
+ * optionally followed by "mm" (e.g., "2440", "12.5 mm").
+ *
+ * @param s The input text; surrounding whitespace is ignored.
+ * @param units The units the text is in.
+ * @param inches Receives the length in inches.
+ * @param error Receives the reason when the text is not a length.
+ * @return Whether the text parsed.
+ */
+bool parseLength(std::string_view s, LengthUnits units, double& inches,
+                 std::string& error) {
+  if (units == LengthUnits::Inches)
+    return parseLength(s, inches, error);
+
+  LengthScanner in(s, error);
+  double millimetres;
+  in.skipSpace();
+  if (in.atEnd())
+    return in.fail("empty length");
+  if (!in.number(millimetres))
+    return false;
+  in.skipSpace();
+  if (in.accept('m') && !in.accept('m'))
+    return in.fail("expected \"mm\"");
+  in.skipSpace();
+  if (!in.atEnd())
+    return in.fail(std::string("unexpected '") + s[in.pos] + "'");
+  inches = millimetres / MM_PER_INCH;
+  return true;
+}
+
+/**
+ * @brief Converts inches to a job's units.
+ * @param inches The length in inches.
+ * @param units The units to express it in.
+ * @return The length in those units.
+ */
+double toUnits(double inches, LengthUnits units) {
+  return units == LengthUnits::Millimetres ? inches * MM_PER_INCH : inches;
+}
+
+/**
+ * @brief Formats a length for display in a job's units.
+ * e.g., 96.0 becomes "8'" in inches and "2438.4 mm" in millimetres
+ * @param inches The length in inches.
+ * @param units The units to display it in.
+ * @return A formatted string.
+ */
+std::string prettyLen(double inches, LengthUnits units) {
+  if (units == LengthUnits::Inches)
+    return prettyLen(inches);
+
+  long long tenths = std::llround(inches * MM_PER_INCH * 10.0);
+  std::stringstream ss;
+  if (tenths < 0) {
+    ss << "-";
+    tenths = -tenths;
+  }
+  ss << tenths / 10;
+  if (tenths % 10 != 0) {
+    ss << "." << tenths % 10;
+  }
+  ss << " mm";
+  return ss.str();
+}
+
+bool parseUnits(std::string_view name, LengthUnits& units) {
+  if (name == "in") {
+    units = LengthUnits::Inches;
+  } else if (name == "mm") {
+    units = LengthUnits::Millimetres;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* unitsName(LengthUnits units) {
+  return units == LengthUnits::Millimetres ? "mm" : "in";
+}
@@ -0,0 +1,318 @@
+#include "patterns.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <thread>
+
+// Pattern sets can hold hundreds of thousands of columns, so only a handful
+// of recent length tables are kept, and only sets up to a share of the
+// byte budget, which bounds the whole cache at PATTERN_CACHE_MAX_BYTES
+const size_t PATTERN_CACHE_ENTRIES = 16;
+const double PATTERN_CACHE_TTL_S = 3600;
+const size_t PATTERN_CACHE_MAX_BYTES = 256 << 20;
+
+using PatternCache = LruCache<JobSignature, std::shared_ptr<const PatternSet>,
+                              JobSignatureHash>;
+
+static PatternCache& patternCache() {
+  static PatternCache cache(PATTERN_CACHE_ENTRIES, PATTERN_CACHE_TTL_S);
+  return cache;
+}
+
+// Enumeration state shared by every thread working on one pattern set.
+// `Int` is the integer type the weights are walked in: 32 bits whenever the
+// stock allows, which halves the memory the inner loop reads.
+template <typename Int> struct EnumerationShared {
+  const std::vector<Int>& weight;
+  Int capacity;
+  bool maximalOnly;
+  const PatternBudget& budget;
+  std::chrono::steady_clock::time_point start;
+  std::atomic<size_t> emitted{0};
+  std::atomic<bool> truncated{false};
+
+  EnumerationShared(const std::vector<Int>& weight_, Int capacity_,
+                    bool maximalOnly_, const PatternBudget& budget_)
+      : weight(weight_), capacity(capacity_), maximalOnly(maximalOnly_),
+        budget(budget_), start(std::chrono::steady_clock::now()) {}
+};
+
+/**
+ * @brief Depth-first walk of the subtree below a fixed prefix of pieces.
+ *
+ * Walks the combination tree with an explicit stack of piece indices
+ * instead of recursion. Lengths are sorted descending and a piece is only
+ * ever followed by one of the same or a later index, so every multiset is
+ * visited exactly once and no deduplication pass is needed. A parallel stack
+ * of (index, count) runs mirrors the current pattern, so each visited node is
+ * written straight out as a sparse column in O(nonzeros).
+ *
+ * @param prefix Non-decreasing piece indices every pattern starts with; the
+ * prefix itself is emitted first. Empty walks the whole tree.
+ * @param descend Whether to visit the children of the prefix at all.
+ */
+template <typename Int>
+static void enumerateFrom(const std::vector<size_t>& prefix, bool descend,
+                          EnumerationShared<Int>& shared, PatternSet& out) {
+  const std::vector<Int>& weight = shared.weight;
+  const size_t n = weight.size();
+
+  // Runs of equal indices in `stack`, i.e. the nonzeros of the pattern
+  struct Run {
+    HighsInt index;
+    int count;
+  };
+  std::vector<size_t> stack;
+  std::vector<Run> runs;
+  stack.reserve(shared.capacity / weight[n - 1] + 1);
+  runs.reserve(n);
+
+  Int remaining = shared.capacity;
+  size_t next = 0;
+  auto push = [&](size_t i) {
+    stack.push_back(i);
+    if (!runs.empty() && runs.back().index == static_cast<HighsInt>(i)) {
+      runs.back().count++;
+    } else {
+      runs.push_back({static_cast<HighsInt>(i), 1});
+    }
+    remaining -= weight[i];
+    next = i;
+  };
+  // Write the current pattern; false once a budget is exhausted
+  auto emit = [&]() {
+    // The smallest piece fits whenever any piece does
+    if (shared.maximalOnly && remaining >= weight[n - 1])
+      return true;
+
+    for (const Run& run : runs) {
+      out.index.push_back(run.index);
+      out.value.push_back(run.count);
+    }
+    out.start.push_back(out.index.size());
+
+    size_t emitted = ++shared.emitted;
+    if (emitted >= shared.budget.maxPatterns) {
+      shared.truncated = true;
+      return false;
+    }
+    // Checking the clock on every pattern would dominate the loop
+    if ((emitted & 4095) == 0) {
+      std::chrono::duration<double, std::milli> elapsed =
+          std::chrono::steady_clock::now() - shared.start;
+      if (elapsed.count() > shared.budget.maxMillis) {
+        shared.truncated = true;
+        return false;
+      }
+    }
+    return !shared.truncated;
+  };
+
+  for (size_t i : prefix) {
+    push(i);
+  }
+  if (!prefix.empty() && !emit())
+    return;
+  if (!descend)
+    return;
+
+  const size_t floor = prefix.size();
+  while (true) {
+    // Weights are descending, so the first index at or after `next` that
+    // fits gives the next child in the same order the recursion used
+    auto fit = std::lower_bound(weight.begin() + next, weight.end(), remaining,
+                                std::greater<Int>());
+    if (fit != weight.end()) {
+      push(fit - weight.begin());
+      if (!emit())
+        return;
+      continue;
+    }
+
+    // No child fits: backtrack and move on to the next sibling
+    if (stack.size() == floor)
+      break;
+    size_t i = stack.back();
+    stack.pop_back();
+    if (--runs.back().count == 0)
+      runs.pop_back();
+    remaining += weight[i];
+    next = i + 1;
+  }
+}
+
+/**
+ * @brief Enumerates the patterns with weights held as `Int`.
+ *
+ * n pieces need n-1 kerfs, so a pattern fits when the sum of (length + kerf)
+ * over its pieces is at most stock + kerf; that keeps the feasibility test a
+ * single subtraction per piece.
+ *
+ * With several threads the tree is cut into tasks by the first one or two
+ * pieces: {i} alone, then {i, j} for every j >= i that fits beside it. In
+ * that order the tasks cover the tree exactly as the serial walk visits it,
+ * so each task writes into its own buffer, and the buffers are concatenated
+ * in task order to give the serial column order regardless of which thread
+ * ran what. Threads claim tasks from the back: a prefix of short pieces
+ * leaves the most room, so the largest subtrees go first and the small ones
+ * at the front fill in the gaps at the end.
+ *
+ * @param result Holds the distinct scaled lengths, descending, and receives
+ * the patterns.
+ * @param maximalOnly Skip patterns that still have room for the smallest
+ * length. Every such pattern is dominated by a maximal one once demand rows
+ * are covering (>=), so they are dead weight in that model.
+ * @param budget Pattern count and wall-clock limits; when one is hit the set
+ * is returned as-is with `truncated` set.
+ * @param threads Worker threads to enumerate with; 1 walks the tree inline.
+ */
+template <typename Int>
+static void enumeratePatterns(PatternSet& result, long long stockLen,
+                              long long kerf, bool maximalOnly,
+                              const PatternBudget& budget, unsigned threads) {
+  const size_t n = result.lengths.size();
+  Int capacity = static_cast<Int>(stockLen + kerf);
+  std::vector<Int> weight(n);
+  for (size_t i = 0; i < n; i++) {
+    weight[i] = static_cast<Int>(result.lengths[i] + kerf);
+  }
+  EnumerationShared<Int> shared(weight, capacity, maximalOnly, budget);
+
+  if (threads <= 1) {
+    // Reserve for a typical job up front; only very large sets grow from
+    // here
+    size_t expected = std::min<size_t>(budget.maxPatterns, 1 << 16);
+    result.start.reserve(expected + 1);
+    result.index.reserve(expected * std::min<size_t>(n, 8));
+    result.value.reserve(expected * std::min<size_t>(n, 8));
+    enumerateFrom<Int>({}, true, shared, result);
+    result.truncated = shared.truncated;
+    return;
+  }
+
+  // Tasks in serial visiting order; a one-piece task only emits itself
+  struct Task {
+    std::vector<size_t> prefix;
+    bool descend;
+  };
+  std::vector<Task> tasks;
+  for (size_t i = 0; i < n; i++) {
+    if (weight[i] > capacity)
+      continue;
+    tasks.push_back({{i}, false});
+    for (size_t j = i; j < n; j++) {
+      if (static_cast<long long>(weight[i]) + weight[j] <= capacity)
+        tasks.push_back({{i, j}, true});
+    }
+  }
+
+  std::vector<PatternSet> buffers(tasks.size());
+  std::atomic<size_t> claimed{0};
+  auto work = [&]() {
+    for (size_t c; (c = claimed++) < tasks.size() && !shared.truncated;) {
+      size_t t = tasks.size() - 1 - c;
+      enumerateFrom<Int>(tasks[t].prefix, tasks[t].descend, shared,
+                         buffers[t]);
+    }
+  };
+  std::vector<std::thread> workers;
+  threads = std::min<unsigned>(threads, tasks.size());
+  for (unsigned w = 1; w < threads; w++) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  size_t columns = 0;
+  size_t nonzeros = 0;
+  for (const auto& buffer : buffers) {
+    columns += buffer.size();
+    nonzeros += buffer.index.size();
+  }
+  result.start.reserve(columns + 1);
+  result.index.reserve(nonzeros);
+  result.value.reserve(nonzeros);
+  for (auto& buffer : buffers) {
+    HighsInt offset = result.index.size();
+    for (size_t p = 1; p < buffer.start.size(); p++) {
+      result.start.push_back(offset + buffer.start[p]);
+    }
+    result.index.insert(result.index.end(), buffer.index.begin(),
+                        buffer.index.end());
+    result.value.insert(result.value.end(), buffer.value.begin(),
+                        buffer.value.end());
+    buffer = PatternSet();
+  }
+  result.truncated = shared.truncated;
+}
+
+/**
+ * @brief Generates all possible cutting patterns using scaled integers.
+ *
+ * Picks the narrowest integer type that holds the stock and every weight:
+ * 32 bits for anything short of two billion units (over 160 km at 1/1024"),
+ * so in practice always, with 64 bits kept for the rest. The column order
+ * is the same either way.
+ *
+ * @param uniqueLengths Distinct scaled cut lengths, in any order.
+ * @return The patterns, empty if no length fits on the stock.
+ */
+PatternSet generatePatterns(const std::vector<long long>& uniqueLengths,
+                            long long stockLen, long long kerf,
+                            bool maximalOnly, const PatternBudget& budget,
+                            unsigned threads) {
+  PatternSet result;
+  result.lengths = uniqueLengths;
+  std::sort(result.lengths.begin(), result.lengths.end(),
+            std::greater<long long>());
+  if (result.lengths.empty())
+    return result;
+
+  long long widest = std::max(stockLen, result.lengths.front()) + kerf;
+  if (widest <= std::numeric_limits<int32_t>::max()) {
+    enumeratePatterns<int32_t>(result, stockLen, kerf, maximalOnly, budget,
+                               threads);
+  } else {
+    enumeratePatterns<int64_t>(result, stockLen, kerf, maximalOnly, budget,
+                               threads);
+  }
+  return result;
+}
+
+std::shared_ptr<const PatternSet>
+cachedPatterns(const std::vector<long long>& uniqueLengths, long long stockLen,
+               long long kerf, bool maximalOnly, const PatternBudget& budget,
+               unsigned threads) {
+  JobSignature key;
+  key.words = uniqueLengths;
+  std::sort(key.words.begin(), key.words.end(), std::greater<long long>());
+  key.words.push_back(stockLen);
+  key.words.push_back(kerf);
+  key.words.push_back(maximalOnly);
+  key.hash = hashWords(key.words);
+
+  std::shared_ptr<const PatternSet> patterns;
+  if (patternCache().get(key, patterns))
+    return patterns;
+
+  patterns = std::make_shared<const PatternSet>(
+      generatePatterns(uniqueLengths, stockLen, kerf, maximalOnly, budget,
+                       threads));
+  size_t bytes = patterns->lengths.size() * sizeof(long long) +
+                 (patterns->start.size() + patterns->index.size()) *
+                     sizeof(HighsInt) +
+                 patterns->value.size() * sizeof(double);
+  if (!patterns->truncated &&
+      bytes <= PATTERN_CACHE_MAX_BYTES / PATTERN_CACHE_ENTRIES) {
+    patternCache().put(key, patterns);
+  }
+  return patterns;
+}
+
+PatternCache::Stats patternCacheStats() { return patternCache().stats(); }
@@ -0,0 +1,245 @@
+#include "report.h"
+#include "parse.h"
+
+#include <algorithm>
+
+/**
+ * @brief Prepares a solution for writing.
+ *
+ * The runs are grouped by layout and every distinct cut length is formatted
+ * once, as the complete `{"length", "pretty_length"}` object the patterns
+ * repeat, so writing a pattern only copies bytes.
+ *
+ * @param solution The cutting solution.
+ * @param stock The job's stock types, as the solution's indices refer to.
+ * @param units The units lengths are written in.
+ */
+SolutionWriter::SolutionWriter(const Solution& solution,
+                               const std::vector<StockType>& stock,
+                               LengthUnits units)
+    : solution_(solution), stock_(stock), units_(units),
+      groups_(groupRuns(solution)) {
+  cuts_.reserve(solution.lengths.size());
+  for (long long scaled : solution.lengths) {
+    double length = scaled / solution.scale;
+    std::string cut = "{\"length\":";
+    JsonWriter::appendNumber(cut, toUnits(length, units));
+    cut += ",\"pretty_length\":";
+    JsonWriter::appendString(cut, prettyLen(length, units));
+    cut += '}';
+    cuts_.push_back(std::move(cut));
+  }
+  stockPretty_.reserve(stock.size());
+  for (const auto& type : stock) {
+    stockPretty_.push_back(prettyLen(type.length, units));
+  }
+}
+
+/**
+ * @brief Estimates the size of the serialized solution.
+ *
+ * The cuts, which make up most of a large plan, are counted exactly from
+ * their preformatted objects; the rest is a per-pattern allowance.
+ *
+ * @return Bytes, normally a little over what write() appends.
+ */
+size_t SolutionWriter::sizeHint() const {
+  size_t bytes = 512 + 96 * (stock_.size() + solution_.offcuts.size());
+  for (const RunGroup& group : groups_) {
+    bytes += 192;
+    for (const auto& [i, quantity] : solution_.runs[group.run].pieces) {
+      bytes += quantity * (cuts_[i].size() + 1);
+    }
+  }
+  return bytes;
+}
+
+/**
+ * @brief Writes the solution totals, stock usage and offcuts, and opens the
+ * patterns array.
+ *
+ * @param out The writer to append to.
+ */
+void SolutionWriter::begin(JsonWriter& out) const {
+  const Solution& solution = solution_;
+  out.beginObject();
+  out.field("num_sticks", solution.num_sticks);
+  out.field("total_waste", toUnits(solution.total_waste, units_));
+  out.field("total_cost", solution.total_cost);
+  out.field("surplus_pieces", solution.surplus_pieces);
+  out.field("status", solution.status);
+  out.field("mip_gap", solution.mip_gap);
+  out.field("objective_bound", solution.objective_bound);
+
+  double totalStock = 0.0;
+  for (const auto& run : solution.runs) {
+    totalStock += run.count * run.stock_len;
+  }
+  out.field("efficiency", totalStock > 0 ? (totalStock - solution.total_waste) /
+                                               totalStock * 100.0
+                                         : 0.0);
+
+  // Sticks drawn from each stock type
+  out.key("stock_used");
+  out.beginArray();
+  for (size_t t = 0; t < stock_.size(); t++) {
+    out.beginObject();
+    out.field("length", toUnits(stock_[t].length, units_));
+    out.field("lengthPretty", stockPretty_[t]);
+    out.field("cost", stock_[t].cost);
+    out.field("available", stock_[t].available);
+    out.field("remnant", stock_[t].remnant);
+    out.field("used",
+              t < solution.stock_used.size() ? solution.stock_used[t] : 0);
+    out.endObject();
+  }
+  out.endArray();
+
+  out.key("offcuts");
+  out.beginArray();
+  for (double offcut : solution.offcuts) {
+    out.beginObject();
+    out.field("length", toUnits(offcut, units_));
+    out.field("lengthPretty", prettyLen(offcut, units_));
+    out.endObject();
+  }
+  out.endArray();
+
+  out.key("patterns");
+  out.beginArray();
+}
+
+/**
+ * @brief Writes the next batch of patterns.
+ *
+ * @param out The writer to append to.
+ * @param maxPatterns Most patterns to write in this call.
+ * @return True while patterns remain after this batch.
+ */
+bool SolutionWriter::next(JsonWriter& out, size_t maxPatterns) {
+  size_t stop = std::min(groups_.size(), written_ + maxPatterns);
+  for (; written_ < stop; written_++) {
+    const RunGroup& group = groups_[written_];
+    const StickRun& run = solution_.runs[group.run];
+    out.beginObject();
+    out.field("count", group.count);
+    out.field("stock_len", toUnits(run.stock_len, units_));
+    out.key("stock_len_pretty");
+    if (run.stock_type >= 0 &&
+        static_cast<size_t>(run.stock_type) < stockPretty_.size() &&
+        stock_[run.stock_type].length == run.stock_len) {
+      out.value(stockPretty_[run.stock_type]);
+    } else {
+      out.value(prettyLen(run.stock_len, units_));
+    }
+    out.field("remnant", run.remnant);
+    out.field("used_len", toUnits(run.used_len, units_));
+    out.field("waste_len", toUnits(run.waste_len, units_));
+    out.key("cuts");
+    out.beginArray();
+    for (const auto& [i, quantity] : run.pieces) {
+      for (int q = 0; q < quantity; q++) {
+        out.raw(cuts_[i]);
+      }
+    }
+    out.endArray();
+    out.endObject();
+  }
+  return written_ < groups_.size();
+}
+
+/**
+ * @brief Closes the patterns array and the solution object.
+ *
+ * @param out The writer to append to.
+ */
+void SolutionWriter::end(JsonWriter& out) const {
+  out.endArray();
+  out.endObject();
+}
+
+/**
+ * @brief Writes the whole solution object in one go.
+ *
+ * @param out The writer to append to.
+ */
+void SolutionWriter::write(JsonWriter& out) {
+  begin(out);
+  while (next(out, groups_.size())) {
+  }
+  end(out);
+}
+
+/**
+ * @brief Writes a saw plan.
+ *
+ * Batches name their pattern by its index in the solution's `patterns`.
+ *
+ * @param out The writer to append to.
+ * @param plan The plan from planSaws.
+ */
+void writeSawPlan(JsonWriter& out, const SawPlan& plan) {
+  out.beginObject();
+  out.field("makespanSeconds", plan.makespan);
+  out.field("setups", plan.setups);
+  out.field("openStacks", plan.openStacks);
+  out.field("evaluated", plan.evaluated);
+  out.key("saws");
+  out.beginArray();
+  for (const SawSchedule& saw : plan.saws) {
+    int sticks = 0;
+    for (const SawBatch& batch : saw.batches) {
+      sticks += batch.sticks;
+    }
+    out.beginObject();
+    out.field("seconds", saw.seconds);
+    out.field("sticks", sticks);
+    out.field("setups", saw.setups);
+    out.field("openStacks", saw.openStacks);
+    out.key("batches");
+    out.beginArray();
+    for (const SawBatch& batch : saw.batches) {
+      out.beginObject();
+      out.field("pattern", batch.pattern);
+      out.field("sticks", batch.sticks);
+      out.endObject();
+    }
+    out.endArray();
+    out.endObject();
+  }
+  out.endArray();
+  out.endObject();
+}
+
+/**
+ * @brief Writes each stick of a solution with the entry of every cut.
+ *
+ * @param out The writer to append to.
+ * @param solution The cutting solution.
+ * @param ids Id runs per length, indices into `entries`.
+ * @param entries Cut list position of each of the request's demands.
+ * @param units The units lengths are written in.
+ */
+void writeSticks(JsonWriter& out, const Solution& solution,
+                 const std::vector<IdRuns>& ids,
+                 const std::vector<int>& entries, LengthUnits units) {
+  out.beginArray();
+  for (const Stick& stick : expandSticks(solution, ids)) {
+    out.beginObject();
+    out.field("stock_len", toUnits(stick.stock_len, units));
+    out.field("remnant", stick.remnant);
+    out.key("cuts");
+    out.beginArray();
+    for (const Cut& cut : stick.cuts) {
+      out.beginObject();
+      out.field("length", toUnits(cut.length, units));
+      out.field("entry", static_cast<size_t>(cut.id) < entries.size()
+                             ? entries[cut.id]
+                             : cut.id);
+      out.endObject();
+    }
+    out.endArray();
+    out.endObject();
+  }
+  out.endArray();
+}
@@ -0,0 +1,241 @@
+#include "request.h"
+#include "parse.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using json = nlohmann::json;
+
+// Saws one plan may be shared between
+const int MAX_SAWS = 64;
+
+// Pieces a request may have when it asks for every stick to be listed
+const long long MAX_STICK_PIECES = 100000;
+
+bool readLength(const std::string& text, LengthUnits units,
+                const std::string& field, double& inches, std::string& error) {
+  std::string reason;
+  if (parseLength(text, units, inches, reason))
+    return true;
+  error = "Invalid " + field + ": " + reason;
+  return false;
+}
+
+bool parseSolveSettings(const json& body, const RequestLimits& limits,
+                        OptimizeRequest& request, std::string& error) {
+  // Extract parameters
+  request.jobName = body.value("jobName", "Cut Plan");
+  request.materialType = body.value("materialType", "Standard Material");
+  std::string kerfStr = body.at("kerf");
+  request.modeStr = body.value("mode", "exhaustive");
+  request.qualityStr = body.value("quality", "optimal");
+
+  // Parse solver mode
+  SolverOptions& options = request.options;
+  options.patternBudget = limits.patternBudget;
+  options.enumerationThreads = limits.enumerationThreads;
+  options.maximalPatterns = body.value("maximalPatterns", false);
+  request.sticks = body.value("sticks", false);
+  options.timeLimitMs = body.value("timeLimitMs", 0.0);
+  options.mipGap = body.value("mipGap", options.mipGap);
+  if (!parseUnits(body.value("units", "in"), options.units)) {
+    error = "Invalid units";
+    return false;
+  }
+  const LengthUnits units = options.units;
+  if (options.timeLimitMs < 0 || options.mipGap < 0) {
+    error = "Invalid time limit or MIP gap";
+    return false;
+  }
+  request.maxQueueMs = body.value("maxQueueMs", limits.maxQueueMs);
+  if (limits.maxQueueMs > 0 &&
+      (request.maxQueueMs <= 0 || request.maxQueueMs > limits.maxQueueMs)) {
+    request.maxQueueMs = limits.maxQueueMs;
+  }
+  if (limits.maxTimeLimitMs > 0 &&
+      (options.timeLimitMs == 0 ||
+       options.timeLimitMs > limits.maxTimeLimitMs)) {
+    options.timeLimitMs = limits.maxTimeLimitMs;
+  }
+
+  // Saw sequencing: a number of saws, or an object with the floor's
+  // timings as well
+  if (body.contains("saws")) {
+    SawSettings& saws = request.saws;
+    const json& item = body.at("saws");
+    if (item.is_number()) {
+      saws.saws = item.get<int>();
+    } else {
+      saws.saws = item.value("count", 1);
+      saws.maxOpenStacks = item.value("maxOpenStacks", saws.maxOpenStacks);
+      saws.stickSeconds = item.value("stickSeconds", saws.stickSeconds);
+      saws.cutSeconds = item.value("cutSeconds", saws.cutSeconds);
+      saws.setupSeconds = item.value("setupSeconds", saws.setupSeconds);
+      saws.timeBudgetMs = item.value("timeBudgetMs", saws.timeBudgetMs);
+    }
+    if (saws.saws < 0 || saws.saws > MAX_SAWS || saws.maxOpenStacks < 0 ||
+        !(saws.stickSeconds >= 0 && saws.cutSeconds >= 0 &&
+          saws.setupSeconds >= 0 && saws.timeBudgetMs >= 0) ||
+        !std::isfinite(saws.stickSeconds + saws.cutSeconds +
+                       saws.setupSeconds)) {
+      error = "Invalid saws";
+      return false;
+    }
+    saws.timeBudgetMs = std::min(saws.timeBudgetMs, limits.maxSequenceMs);
+    saws.threads = limits.enumerationThreads;
+  }
+
+  // Parse result quality
+  if (request.qualityStr == "optimal") {
+    options.quality = SolveQuality::Optimal;
+  } else if (request.qualityStr == "fast") {
+    options.quality = SolveQuality::Fast;
+  } else {
+    error = "Invalid quality";
+    return false;
+  }
+  if (request.modeStr == "exhaustive") {
+    options.mode = SolverMode::Exhaustive;
+  } else if (request.modeStr == "column_generation") {
+    options.mode = SolverMode::ColumnGeneration;
+  } else {
+    error = "Invalid solver mode";
+    return false;
+  }
+
+  // Parse stock: a list of lengths with optional cost and availability,
+  // or the single unlimited "stockLength"
+  std::vector<StockType>& stock = request.stock;
+  if (body.contains("stockLengths")) {
+    for (const auto& item : body.at("stockLengths")) {
+      std::string lengthStr = item.at("length").get<std::string>();
+      double length;
+      if (!readLength(lengthStr, units, "stock length", length, error))
+        return false;
+      StockType type(length, item.value("cost", 1.0),
+                     item.value("available", -1));
+      if (type.length <= 0 || type.cost < 0 || type.available < -1) {
+        error = "Invalid stock length";
+        return false;
+      }
+      stock.push_back(type);
+    }
+  } else {
+    std::string stockLengthStr = body.at("stockLength");
+    double length;
+    if (!readLength(stockLengthStr, units, "stock length", length,
+                    error))
+      return false;
+    stock.push_back(StockType(length));
+    if (stock.back().length <= 0) {
+      error = "Invalid stock length";
+      return false;
+    }
+  }
+
+  // Remnants on hand are extra, capped stock types priced below new stock
+  if (body.contains("remnants")) {
+    std::vector<StockType> newStock = stock;
+    for (const auto& item : body.at("remnants")) {
+      std::string lengthStr = item.at("length").get<std::string>();
+      double length;
+      if (!readLength(lengthStr, units, "remnant length", length, error))
+        return false;
+      int quantity = item.value("quantity", 1);
+      if (length <= 0 || quantity < 0) {
+        error = "Invalid remnant";
+        return false;
+      }
+      StockType remnant = remnantStock(length, quantity, newStock);
+      remnant.cost = item.value("cost", remnant.cost);
+      stock.push_back(remnant);
+    }
+  }
+  if (body.contains("offcutThreshold")) {
+    if (!readLength(body.at("offcutThreshold").get<std::string>(), units,
+                    "offcut threshold", options.offcutThreshold, error))
+      return false;
+  }
+
+  // The longest stock on hand bounds every cut
+  for (const auto& type : stock) {
+    if (type.available != 0) {
+      request.stockLen = std::max(request.stockLen, type.length);
+    }
+  }
+  if (request.stockLen <= 0) {
+    error = "No stock available";
+    return false;
+  }
+
+  // Parse kerf: a fraction of an inch, or millimetres for a metric job.
+  // A blank kerf falls back to the default like a zero one.
+  std::string reason;
+  request.kerf = 0.0;
+  if (kerfStr.find_first_not_of(" \t") != std::string::npos &&
+      !(units == LengthUnits::Inches
+            ? parseFraction(kerfStr, request.kerf, reason)
+            : parseLength(kerfStr, units, request.kerf, reason))) {
+    error = "Invalid kerf: " + reason;
+    return false;
+  }
+  if (request.kerf <= 0) {
+    // Default to 1/8", or a 3 mm blade
+    request.kerf = units == LengthUnits::Inches ? 0.125 : 3.0 / MM_PER_INCH;
+  }
+
+  return true;
+}
+
+bool addCuts(OptimizeRequest& request, double length, long long quantity,
+             const std::string& label, std::string& error) {
+  int entry = request.listed++;
+  if (length <= 0 || quantity <= 0)
+    return true;
+
+  if (length > request.stockLen) {
+    error = "Cut length exceeds stock length";
+    return false;
+  }
+
+  // Demand rows are ints in the solver
+  if (quantity > std::numeric_limits<int>::max() - request.pieces) {
+    error = "Too many pieces";
+    return false;
+  }
+  if (request.sticks && quantity > MAX_STICK_PIECES - request.pieces) {
+    error = "Too many pieces to list every stick (at most " +
+            std::to_string(MAX_STICK_PIECES) + ")";
+    return false;
+  }
+  request.pieces += quantity;
+  request.demands.push_back(
+      Demand(length, static_cast<int>(quantity), label));
+  request.entries.push_back(entry);
+  return true;
+}
+
+bool parseOptimizeRequest(const json& body, const RequestLimits& limits,
+                          OptimizeRequest& request, std::string& error) {
+  if (!parseSolveSettings(body, limits, request, error))
+    return false;
+
+  // Parse cuts
+  for (const auto& cutItem : body.at("cuts")) {
+    double length;
+    if (!readLength(cutItem.at("length").get<std::string>(),
+                    request.options.units, "cut length", length, error))
+      return false;
+    if (!addCuts(request, length, cutItem.at("quantity").get<long long>(),
+                 cutItem.value("label", ""), error))
+      return false;
+  }
+
+  if (request.demands.empty()) {
+    error = "No valid cuts provided";
+    return false;
+  }
+  return true;
+}
+
@@ -0,0 +1,441 @@
+#include "sequence.h"
+#include "output.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <utility>
+
+using Clock = std::chrono::steady_clock;
+
+// Plans with more patterns than this are chained in layout order rather
+// than by nearest neighbour, which is quadratic in them
+const size_t NEAREST_NEIGHBOUR_PATTERNS = 2000;
+// Search moves between looks at the clock
+const long long MOVES_PER_CLOCK_CHECK = 64;
+// Moves in a row that find no better plan before a search gives up ahead
+// of its deadline
+const long long STALL_MOVES = 20000;
+
+// What one pattern costs on a saw
+struct PatternWork {
+  std::vector<int> lengths; // distinct length indices, ascending
+  int sticks{0};            // over the whole plan
+  double stickSeconds{0.0}; // one stick with all its cuts
+};
+
+// Rank of a candidate plan, lower being better
+struct PlanScore {
+  int excessStacks{0}; // open stacks over the limit, summed over saws
+  double makespan{0.0};
+  double total{0.0}; // saw time over all saws
+
+  bool operator<(const PlanScore& other) const {
+    if (excessStacks != other.excessStacks)
+      return excessStacks < other.excessStacks;
+    if (std::abs(makespan - other.makespan) > 1e-6)
+      return makespan < other.makespan;
+    return total < other.total - 1e-6;
+  }
+};
+
+/**
+ * @brief Counts the stops to move from one pattern to the next.
+ *
+ * @param from The pattern the saw is set up for, or null before the first.
+ * @param to The pattern cut next.
+ * @return The lengths of `to` that `from` has no stop for.
+ */
+static int stopChanges(const PatternWork* from, const PatternWork& to) {
+  if (from == nullptr)
+    return static_cast<int>(to.lengths.size());
+  int changes = 0;
+  auto have = from->lengths.begin();
+  for (int i : to.lengths) {
+    while (have != from->lengths.end() && *have < i) {
+      ++have;
+    }
+    if (have == from->lengths.end() || *have != i)
+      changes++;
+  }
+  return changes;
+}
+
+// Scores saw sequences, with the per-length scratch that takes
+class SawEvaluator {
+public:
+  SawEvaluator(const std::vector<PatternWork>& work,
+               const SawSettings& settings, size_t numLengths)
+      : work_(work), settings_(settings), first_(numLengths, -1),
+        last_(numLengths, 0) {}
+
+  // Fill in a saw's time, setups and open stacks from its batches
+  void evaluate(SawSchedule& saw);
+  PlanScore score(const std::vector<SawSchedule>& saws) const;
+
+private:
+  const std::vector<PatternWork>& work_;
+  const SawSettings& settings_;
+  std::vector<int> first_; // batch a length's stack opens at, -1 if none
+  std::vector<int> last_;  // batch it closes after
+  std::vector<int> touched_;
+  std::vector<int> delta_; // stacks opened minus closed per batch
+};
+
+/**
+ * @brief Times one saw's sequence and sweeps its part stacks.
+ *
+ * A length's stack is open from the first batch with that length to the
+ * last, so the most open at once is the peak of a running sum over the
+ * batches, O(batches + nonzeros).
+ */
+void SawEvaluator::evaluate(SawSchedule& saw) {
+  const PatternWork* previous = nullptr;
+  saw.seconds = 0.0;
+  saw.setups = 0;
+  for (size_t k = 0; k < saw.batches.size(); k++) {
+    const PatternWork& pattern = work_[saw.batches[k].pattern];
+    saw.seconds += saw.batches[k].sticks * pattern.stickSeconds;
+    saw.setups += stopChanges(previous, pattern);
+    previous = &pattern;
+    for (int i : pattern.lengths) {
+      if (first_[i] < 0) {
+        first_[i] = static_cast<int>(k);
+        touched_.push_back(i);
+      }
+      last_[i] = static_cast<int>(k);
+    }
+  }
+  saw.seconds += saw.setups * settings_.setupSeconds;
+
+  delta_.assign(saw.batches.size() + 1, 0);
+  for (int i : touched_) {
+    delta_[first_[i]]++;
+    delta_[last_[i] + 1]--;
+    first_[i] = -1;
+  }
+  touched_.clear();
+  int open = 0;
+  saw.openStacks = 0;
+  for (int change : delta_) {
+    open += change;
+    saw.openStacks = std::max(saw.openStacks, open);
+  }
+}
+
+PlanScore SawEvaluator::score(const std::vector<SawSchedule>& saws) const {
+  PlanScore score;
+  for (const auto& saw : saws) {
+    if (settings_.maxOpenStacks > 0 &&
+        saw.openStacks > settings_.maxOpenStacks) {
+      score.excessStacks += saw.openStacks - settings_.maxOpenStacks;
+    }
+    score.makespan = std::max(score.makespan, saw.seconds);
+    score.total += saw.seconds;
+  }
+  return score;
+}
+
+/**
+ * @brief Builds the starting plan: a low-setup chain cut into equal shares.
+ *
+ * The chain starts from the most-used pattern and goes on to the one that
+ * moves the fewest stops, then drops the fewest of the current lengths, so
+ * shared lengths keep their stacks open for as short a stretch as possible.
+ * It is then cut into one stretch of about equal time per saw, splitting a
+ * pattern's sticks where a stretch ends.
+ */
+static std::vector<SawSchedule>
+greedyStart(const std::vector<PatternWork>& work,
+            const SawSettings& settings) {
+  std::vector<size_t> chain;
+  chain.reserve(work.size());
+  if (work.size() > NEAREST_NEIGHBOUR_PATTERNS) {
+    for (size_t p = 0; p < work.size(); p++) {
+      chain.push_back(p);
+    }
+    std::stable_sort(chain.begin(), chain.end(), [&](size_t a, size_t b) {
+      return work[a].lengths < work[b].lengths;
+    });
+  } else if (!work.empty()) {
+    std::vector<char> used(work.size(), 0);
+    size_t current = 0;
+    used[current] = 1;
+    chain.push_back(current);
+    for (size_t step = 1; step < work.size(); step++) {
+      size_t next = work.size();
+      std::pair<int, int> nextCost;
+      for (size_t p = 0; p < work.size(); p++) {
+        if (used[p])
+          continue;
+        std::pair<int, int> cost(stopChanges(&work[current], work[p]),
+                                 stopChanges(&work[p], work[current]));
+        if (next == work.size() || cost < nextCost) {
+          next = p;
+          nextCost = cost;
+        }
+      }
+      used[next] = 1;
+      chain.push_back(next);
+      current = next;
+    }
+  }
+
+  double total = 0.0;
+  for (const auto& pattern : work) {
+    total += pattern.sticks * pattern.stickSeconds;
+  }
+  const size_t numSaws = static_cast<size_t>(settings.saws);
+  const double share = total / numSaws;
+  std::vector<SawSchedule> saws(numSaws);
+  size_t saw = 0;
+  double filled = 0.0;
+  for (size_t p : chain) {
+    int remaining = work[p].sticks;
+    while (remaining > 0) {
+      int take = remaining;
+      if (saw + 1 < numSaws && work[p].stickSeconds > 0) {
+        long long fits =
+            std::llround((share - filled) / work[p].stickSeconds);
+        take = static_cast<int>(
+            std::min<long long>(remaining, std::max<long long>(fits, 0)));
+      }
+      if (take == 0) {
+        saw++;
+        filled = 0.0;
+        continue;
+      }
+      saws[saw].batches.push_back({p, take});
+      filled += take * work[p].stickSeconds;
+      remaining -= take;
+    }
+  }
+  return saws;
+}
+
+// Add sticks of a pattern to a saw: onto its batch of that pattern when it
+// has one, so a saw never sets up for a pattern twice, else as a new batch
+static void addSticks(SawSchedule& saw, size_t pattern, int sticks,
+                      size_t position) {
+  for (auto& batch : saw.batches) {
+    if (batch.pattern == pattern) {
+      batch.sticks += sticks;
+      return;
+    }
+  }
+  saw.batches.insert(saw.batches.begin() + position, {pattern, sticks});
+}
+
+/**
+ * @brief Applies one random change to saws `a` and `b`.
+ *
+ * On a single saw, a batch moves to another place in the sequence or a
+ * stretch of it is reversed. Between saws, a batch, or some of its sticks,
+ * moves from `a` to `b`.
+ *
+ * @return False when the move turned out to change nothing.
+ */
+static bool applyMove(std::vector<SawSchedule>& saws, size_t a, size_t b,
+                      std::mt19937_64& rng) {
+  std::vector<SawBatch>& from = saws[a].batches;
+  auto pick = [&](size_t n) {
+    return static_cast<size_t>(std::uniform_int_distribution<size_t>(
+        0, n - 1)(rng));
+  };
+  if (a == b) {
+    if (from.size() < 2)
+      return false;
+    size_t i = pick(from.size());
+    size_t j = pick(from.size());
+    if (i == j)
+      return false;
+    if (rng() & 1) {
+      SawBatch batch = from[i];
+      from.erase(from.begin() + i);
+      from.insert(from.begin() + j, batch);
+    } else {
+      std::reverse(from.begin() + std::min(i, j),
+                   from.begin() + std::max(i, j) + 1);
+    }
+    return true;
+  }
+
+  if (from.empty())
+    return false;
+  size_t i = pick(from.size());
+  SawBatch batch = from[i];
+  int sticks = batch.sticks;
+  if (sticks > 1 && (rng() & 1)) {
+    sticks = 1 + static_cast<int>(pick(batch.sticks - 1));
+  }
+  if (sticks == batch.sticks) {
+    from.erase(from.begin() + i);
+  } else {
+    from[i].sticks -= sticks;
+  }
+  std::vector<SawBatch>& to = saws[b].batches;
+  addSticks(saws[b], batch.pattern, sticks, pick(to.size() + 1));
+  return true;
+}
+
+struct SearchResult {
+  std::vector<SawSchedule> saws;
+  PlanScore score;
+  long long evaluated{0};
+};
+
+// Whether applyMove can change the plan at all: sticks can always go from
+// one saw to another, and a lone saw needs two batches to reorder
+static bool canMove(const std::vector<SawSchedule>& saws) {
+  size_t batches = 0;
+  for (const auto& saw : saws) {
+    batches += saw.batches.size();
+  }
+  return saws.size() > 1 ? batches > 0 : batches > 1;
+}
+
+/**
+ * @brief Improves a plan by random moves until the deadline, or until
+ * STALL_MOVES moves in a row have found nothing better.
+ *
+ * Moves that leave the plan no worse are kept, so the search can drift
+ * across equally good plans. Half the moves take work off the saw that
+ * finishes last, the rest go to a random saw, and only the one or two saws
+ * a move touched are scored again.
+ *
+ * @param seed Random seed; each thread searches with its own.
+ */
+static SearchResult localSearch(std::vector<SawSchedule> saws,
+                                const std::vector<PatternWork>& work,
+                                const SawSettings& settings,
+                                size_t numLengths, uint64_t seed,
+                                Clock::time_point deadline) {
+  SawEvaluator evaluator(work, settings, numLengths);
+  for (auto& saw : saws) {
+    evaluator.evaluate(saw);
+  }
+  SearchResult best;
+  best.saws = saws;
+  best.score = evaluator.score(saws);
+  PlanScore current = best.score;
+
+  if (!canMove(saws))
+    return best;
+
+  std::mt19937_64 rng(seed);
+  SawSchedule savedA, savedB;
+  long long lastImproved = 0;
+  for (long long move = 0; move - lastImproved < STALL_MOVES; move++) {
+    if (move % MOVES_PER_CLOCK_CHECK == 0 && Clock::now() >= deadline)
+      break;
+    size_t a = rng() % saws.size();
+    if (rng() & 1) {
+      for (size_t s = 0; s < saws.size(); s++) {
+        if (saws[s].seconds > saws[a].seconds)
+          a = s;
+      }
+    }
+    size_t b = a;
+    if (saws.size() > 1 && (rng() & 1)) {
+      b = (a + 1 + rng() % (saws.size() - 1)) % saws.size();
+    }
+
+    savedA = saws[a];
+    if (b != a)
+      savedB = saws[b];
+    if (!applyMove(saws, a, b, rng))
+      continue;
+    evaluator.evaluate(saws[a]);
+    if (b != a)
+      evaluator.evaluate(saws[b]);
+    best.evaluated++;
+
+    PlanScore candidate = evaluator.score(saws);
+    if (current < candidate) {
+      saws[a] = std::move(savedA);
+      if (b != a)
+        saws[b] = std::move(savedB);
+      continue;
+    }
+    current = candidate;
+    if (current < best.score) {
+      best.saws = saws;
+      best.score = current;
+      lastImproved = move;
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief Sequences a solution's patterns on the saws.
+ *
+ * Every thread searches from the same greedy start with its own seed, and
+ * the best plan wins, the lowest thread on a tie. The extra threads are
+ * started here, so a server calls this on a solver thread and gives it that
+ * thread's share of the cores as `settings.threads`.
+ *
+ * @param solution The cutting solution; patterns are taken in groupRuns
+ * order, as the response lists them.
+ * @param settings Number of saws, their timings and the search budget.
+ * @return An empty plan when `settings.saws` is 0.
+ */
+SawPlan planSaws(const Solution& solution, const SawSettings& settings) {
+  SawPlan plan;
+  if (settings.saws <= 0)
+    return plan;
+  // The budget covers the greedy start too
+  Clock::time_point deadline =
+      Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                         std::chrono::duration<double, std::milli>(
+                             std::max(settings.timeBudgetMs, 0.0)));
+
+  std::vector<RunGroup> groups = groupRuns(solution);
+  std::vector<PatternWork> work(groups.size());
+  for (size_t g = 0; g < groups.size(); g++) {
+    int cuts = 0;
+    for (const auto& [i, quantity] : solution.runs[groups[g].run].pieces) {
+      work[g].lengths.push_back(i);
+      cuts += quantity;
+    }
+    std::sort(work[g].lengths.begin(), work[g].lengths.end());
+    work[g].lengths.erase(
+        std::unique(work[g].lengths.begin(), work[g].lengths.end()),
+        work[g].lengths.end());
+    work[g].sticks = groups[g].count;
+    work[g].stickSeconds = settings.stickSeconds + cuts * settings.cutSeconds;
+  }
+
+  std::vector<SawSchedule> start = greedyStart(work, settings);
+  const size_t numLengths = solution.lengths.size();
+  unsigned threads = canMove(start) ? std::max(1u, settings.threads) : 1;
+  std::vector<SearchResult> results(threads);
+  auto search = [&](unsigned t) {
+    results[t] = localSearch(start, work, settings, numLengths, t + 1,
+                             deadline);
+  };
+  std::vector<std::thread> workers;
+  for (unsigned t = 1; t < threads; t++) {
+    workers.emplace_back(search, t);
+  }
+  search(0);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  size_t winner = 0;
+  for (size_t t = 0; t < results.size(); t++) {
+    plan.evaluated += results[t].evaluated;
+    if (results[t].score < results[winner].score)
+      winner = t;
+  }
+  plan.saws = std::move(results[winner].saws);
+  for (const auto& saw : plan.saws) {
+    plan.makespan = std::max(plan.makespan, saw.seconds);
+    plan.setups += saw.setups;
+    plan.openStacks = std::max(plan.openStacks, saw.openStacks);
+  }
+  return plan;
+}
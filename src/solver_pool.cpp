@@ -0,0 +1,134 @@
+#include "solver_pool.h"
+#include "arena.h"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+
+// Weight of the newest solve in the moving average of solve times
+const double SOLVE_TIME_SMOOTHING = 0.2;
+
+SolverPool::SolverPool(size_t threads, size_t maxQueued)
+    : maxQueued_(maxQueued) {
+  threads = std::max<size_t>(threads, 1);
+  workers_.reserve(threads);
+  for (size_t i = 0; i < threads; i++) {
+    workers_.emplace_back(&SolverPool::workerLoop, this);
+  }
+}
+
+SolverPool::~SolverPool() { shutdown(); }
+
+uint64_t SolverPool::submit(std::function<Solution()> solve, double maxWaitMs,
+                            std::future<Solution>& result) {
+  Job job;
+  job.solve = std::move(solve);
+  job.expires =
+      maxWaitMs > 0
+          ? Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                               std::chrono::duration<double, std::milli>(
+                                   maxWaitMs))
+          : Clock::time_point::max();
+  result = job.result.get_future();
+
+  uint64_t ticket;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || queue_.size() >= maxQueued_) {
+      rejected_++;
+      return 0;
+    }
+    ticket = job.ticket = nextTicket_++;
+    queue_.push_back(std::move(job));
+  }
+  accepted_++;
+  ready_.notify_one();
+  return ticket;
+}
+
+bool SolverPool::withdraw(uint64_t ticket) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = std::find_if(queue_.begin(), queue_.end(),
+                         [ticket](const Job& job) {
+                           return job.ticket == ticket;
+                         });
+  if (it == queue_.end())
+    return false;
+  queue_.erase(it);
+  expired_++;
+  return true;
+}
+
+int SolverPool::retryAfterSeconds() const {
+  size_t backlog;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    backlog = queue_.size() + running_;
+  }
+  double waitMs = averageSolveMs_.load() * (backlog + 1) /
+                  std::max<size_t>(workers_.size(), 1);
+  return std::max(1, static_cast<int>(std::ceil(waitMs / 1000.0)));
+}
+
+SolverPool::Stats SolverPool::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return {workers_.size(), maxQueued_,     queue_.size(), running_,
+          accepted_.load(), rejected_.load(), expired_.load()};
+}
+
+void SolverPool::shutdown() {
+  std::deque<Job> abandoned;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_)
+      return;
+    stopping_ = true;
+    abandoned.swap(queue_);
+  }
+  ready_.notify_all();
+  for (auto& job : abandoned) {
+    job.result.set_exception(std::make_exception_ptr(QueueTimeout()));
+  }
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void SolverPool::workerLoop() {
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty())
+        return;
+      job = std::move(queue_.front());
+      queue_.pop_front();
+      // A client that has given up waiting would never see the result
+      if (Clock::now() > job.expires) {
+        expired_++;
+        lock.unlock();
+        job.result.set_exception(std::make_exception_ptr(QueueTimeout()));
+        continue;
+      }
+      running_++;
+    }
+
+    // Everything the solve put on this thread's arena goes in one reset
+    // when it returns, and the arena is kept for the next job
+    Clock::time_point start = Clock::now();
+    try {
+      ScratchScope scope;
+      job.result.set_value(job.solve());
+    } catch (...) {
+      job.result.set_exception(std::current_exception());
+    }
+    std::chrono::duration<double, std::milli> took = Clock::now() - start;
+
+    double average = averageSolveMs_.load();
+    averageSolveMs_.store(average + SOLVE_TIME_SMOOTHING *
+                                        (took.count() - average));
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_--;
+  }
+}
@@ -0,0 +1,177 @@
+#include "static_assets.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <zlib.h>
+
+namespace fs = std::filesystem;
+
+// 64-bit FNV-1a over the bytes, good enough to tell file versions apart
+static std::string etagFor(const std::string& body) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (unsigned char c : body) {
+    hash = (hash ^ c) * 0x100000001b3ULL;
+  }
+  char text[24];
+  std::snprintf(text, sizeof(text), "\"%016llx\"",
+                static_cast<unsigned long long>(hash));
+  return text;
+}
+
+// Text formats shrink under gzip; images and fonts are compressed already
+static bool compressible(const std::string& contentType) {
+  return contentType.compare(0, 5, "text/") == 0 ||
+         contentType == "application/javascript" ||
+         contentType == "application/json" ||
+         contentType == "application/manifest+json" ||
+         contentType == "image/svg+xml";
+}
+
+// gzip at the highest level, since it is paid once per file; empty if zlib
+// fails
+static std::string gzip(const std::string& body) {
+  z_stream stream{};
+  if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK)
+    return "";
+  std::string out(deflateBound(&stream, body.size()), '\0');
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+  stream.avail_in = static_cast<uInt>(body.size());
+  stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+  stream.avail_out = static_cast<uInt>(out.size());
+  int status = deflate(&stream, Z_FINISH);
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+  return status == Z_STREAM_END ? out : "";
+}
+
+// A request path that stays inside the root: relative, no ".." segments
+static bool safePath(const std::string& path) {
+  if (path.empty() || path[0] == '/' || path.find('\\') != std::string::npos)
+    return false;
+  for (const auto& part : fs::path(path)) {
+    if (part == "..")
+      return false;
+  }
+  return true;
+}
+
+std::string StaticAssets::contentTypeFor(const std::string& path) {
+  std::string ext = fs::path(path).extension().string();
+  if (ext == ".html")
+    return "text/html; charset=utf-8";
+  if (ext == ".css")
+    return "text/css; charset=utf-8";
+  if (ext == ".js")
+    return "application/javascript";
+  if (ext == ".json")
+    return "application/json";
+  if (ext == ".webmanifest")
+    return "application/manifest+json";
+  if (ext == ".png")
+    return "image/png";
+  if (ext == ".jpg" || ext == ".jpeg")
+    return "image/jpeg";
+  if (ext == ".svg")
+    return "image/svg+xml";
+  if (ext == ".ico")
+    return "image/x-icon";
+  if (ext == ".woff2")
+    return "font/woff2";
+  return "text/plain; charset=utf-8";
+}
+
+StaticAssets::StaticAssets(const std::vector<std::string>& roots,
+                           bool hotReload)
+    : hotReload_(hotReload) {
+  std::error_code ec;
+  for (const auto& root : roots) {
+    if (fs::is_directory(root, ec)) {
+      root_ = root;
+      break;
+    }
+  }
+  if (root_.empty())
+    return;
+
+  for (fs::recursive_directory_iterator it(root_, ec), end; !ec && it != end;
+       it.increment(ec)) {
+    if (!it->is_regular_file(ec))
+      continue;
+    std::string path = fs::relative(it->path(), root_, ec).generic_string();
+    if (auto asset = load(path)) {
+      assets_[path] = asset;
+    }
+  }
+}
+
+std::shared_ptr<const StaticAsset>
+StaticAssets::load(const std::string& path) const {
+  fs::path file = fs::path(root_) / path;
+  std::error_code ec;
+  auto asset = std::make_shared<StaticAsset>();
+  asset->modified = fs::last_write_time(file, ec);
+  asset->size = fs::file_size(file, ec);
+  if (ec)
+    return nullptr;
+
+  std::ifstream in(file, std::ios::binary);
+  if (!in)
+    return nullptr;
+  asset->body.assign(std::istreambuf_iterator<char>(in),
+                     std::istreambuf_iterator<char>());
+  asset->contentType = contentTypeFor(path);
+  asset->etag = etagFor(asset->body);
+  if (compressible(asset->contentType)) {
+    std::string packed = gzip(asset->body);
+    if (!packed.empty() && packed.size() < asset->body.size()) {
+      asset->gzipped = std::move(packed);
+    }
+  }
+  return asset;
+}
+
+std::shared_ptr<const StaticAsset>
+StaticAssets::find(const std::string& path) {
+  if (root_.empty() || !safePath(path))
+    return nullptr;
+
+  std::shared_ptr<const StaticAsset> cached;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = assets_.find(path);
+    if (it != assets_.end())
+      cached = it->second;
+  }
+  if (!hotReload_)
+    return cached;
+
+  // Re-read the file when it changed on disk, outside the lock
+  fs::path file = fs::path(root_) / path;
+  std::error_code ec;
+  if (!fs::is_regular_file(file, ec)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    assets_.erase(path);
+    return nullptr;
+  }
+  auto modified = fs::last_write_time(file, ec);
+  auto size = fs::file_size(file, ec);
+  if (cached && !ec && cached->modified == modified && cached->size == size)
+    return cached;
+  auto fresh = load(path);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (fresh) {
+    assets_[path] = fresh;
+  } else {
+    assets_.erase(path);
+  }
+  return fresh;
+}
+
+size_t StaticAssets::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return assets_.size();
+}
@@ -1,10 +1,17 @@
+#include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <ctime>
-#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
 #include <iomanip>
-#include <iostream>
+#include <map>
+#include <memory>
 #include <signal.h>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
 
 // Single-header libraries (will be downloaded to include/ directory)
 #include "httplib.h"
@@ -12,120 +19,554 @@
 
 // Project headers
 #include "algorithm.h"
+#include "arena.h"
+#include "cache.h"
+#include "cut_list.h"
+#include "job_store.h"
+#include "json_writer.h"
+#include "logger.h"
+#include "metrics.h"
 #include "output.h"
 #include "parse.h"
+#include "report.h"
+#include "request.h"
+#include "sequence.h"
+#include "solver_pool.h"
+#include "static_assets.h"
 #include "types.h"
 
 using json = nlohmann::json;
 
 httplib::Server* g_svr = nullptr;
 
+// Pattern budget, time and queue limits applied to every request, set from
+// the environment at startup so clients cannot raise them
+RequestLimits g_limits;
+
+// Recently solved jobs, so resubmitted cut lists skip the solver entirely
+using SolutionCache =
+    LruCache<JobSignature, std::shared_ptr<const Solution>, JobSignatureHash>;
+std::unique_ptr<SolutionCache> g_solutionCache;
+
+// Saw plans made for cached solutions, keyed on the job and the saw
+// settings. An entry holds the solution it was planned from and answers for
+// that one only, since a job solved again can come out with other patterns.
+struct SawPlanEntry {
+  std::shared_ptr<const Solution> solution;
+  std::shared_ptr<const SawPlan> plan;
+};
+using SawPlanCache = LruCache<JobSignature, SawPlanEntry, JobSignatureHash>;
+std::unique_ptr<SawPlanCache> g_sawPlanCache;
+
+// Solver threads, separate from the HTTP connection threads so health and
+// static routes stay responsive while jobs run
+std::unique_ptr<SolverPool> g_solverPool;
+
+// Most jobs accepted in one /api/optimize/batch request
+size_t g_maxBatch = 100;
+
+// Phase timings and solver sizes, served at /api/metrics
+RequestMetrics g_metrics;
+
+// Asynchronous jobs submitted through /api/jobs
+std::unique_ptr<JobStore> g_jobStore;
+
+// Web UI files, read and compressed once at startup
+std::unique_ptr<StaticAssets> g_staticAssets;
+
+// Cache-Control for /static/ files. They are not fingerprinted, so this is
+// kept short and the ETag makes revalidation cheap.
+std::string g_staticCacheControl = "public, max-age=600";
+
+// Solutions with more runs than this are sent chunked, kStreamBatch
+// patterns per chunk, instead of as one buffer
+size_t g_streamPatterns = 1000;
+const size_t kStreamBatch = 256;
+
+// A chunked response in progress: the writer, what it writes from, and the
+// chunk being filled
+struct ResponseStream {
+  std::shared_ptr<const Solution> solution;
+  std::vector<StockType> stock;
+  std::string buffer;
+  JsonWriter out{buffer};
+  std::unique_ptr<SolutionWriter> writer;
+};
+
+// Open event streams, each holding an HTTP thread, and their ceiling
+std::atomic<size_t> g_openStreams{0};
+size_t g_maxStreams = 16;
+
+// Read a numeric setting from the environment, falling back to a default
+double envOr(const char* name, double fallback) {
+  const char* value = std::getenv(name);
+  if (value == nullptr || *value == '\0')
+    return fallback;
+  try {
+    return std::stod(value);
+  } catch (const std::exception&) {
+    return fallback;
+  }
+}
+
 void signalHandler(int signum) {
   if (g_svr) {
-    json log;
-    log["timestamp"] = std::time(nullptr);
-    log["level"] = "INFO";
-    log["message"] = "Shutting down server gracefully";
-    std::cout << log.dump() << std::endl;
+    Logger::log(Logger::INFO, "Shutting down server gracefully");
     g_svr->stop();
   }
 }
 
-class Logger {
-public:
-  enum Level { DEBUG, INFO, WARN, ERROR };
-
-  static std::string levelToString(Level level) {
-    switch (level) {
-      case DEBUG: return "DEBUG";
-      case INFO: return "INFO";
-      case WARN: return "WARN";
-      case ERROR: return "ERROR";
-      default: return "UNKNOWN";
-    }
+// Write a static asset, or 304 when the client's copy is current. The
+// body is streamed from the shared asset rather than copied into the
+// response.
+void serveAsset(const httplib::Request& req, httplib::Response& res,
+                const std::string& path, const std::string& cacheControl) {
+  auto asset = g_staticAssets->find(path);
+  if (!asset) {
+    Logger::log(Logger::WARN, "Static file not found: " + path);
+    res.status = 404;
+    res.set_content("File not found", "text/plain");
+    return;
   }
 
-  static void log(Level level, const std::string& message) {
-    json log;
-    log["timestamp"] = std::time(nullptr);
-    log["level"] = levelToString(level);
-    log["message"] = message;
-    std::cout << log.dump() << std::endl;
+  res.set_header("ETag", asset->etag);
+  res.set_header("Cache-Control", cacheControl);
+  if (!asset->gzipped.empty()) {
+    res.set_header("Vary", "Accept-Encoding");
+  }
+  std::string ifNoneMatch = req.get_header_value("If-None-Match");
+  if (ifNoneMatch == "*" ||
+      ifNoneMatch.find(asset->etag) != std::string::npos) {
+    res.status = 304;
+    return;
   }
 
-  static void logRequest(const std::string& method, const std::string& path,
-                         int status, const std::string& remoteAddr,
-                         const std::string& remotePort, double duration_ms = -1) {
-    if (path == "/" || path == "/api/health") {
-      return;
-    }
+  std::string encoding = req.get_header_value("Accept-Encoding");
+  bool gzip = !asset->gzipped.empty() &&
+              encoding.find("gzip") != std::string::npos &&
+              encoding.find("gzip;q=0") == std::string::npos;
+  if (gzip) {
+    res.set_header("Content-Encoding", "gzip");
+  }
+  const std::string* body = gzip ? &asset->gzipped : &asset->body;
+  res.set_content_provider(
+      body->size(), asset->contentType,
+      [asset, body](size_t offset, size_t length, httplib::DataSink& sink) {
+        return sink.write(body->data() + offset, length);
+      });
+}
 
-    json log;
-    log["timestamp"] = std::time(nullptr);
-    log["level"] = status >= 400 ? "ERROR" : "INFO";
-    log["type"] = "http_request";
-    log["method"] = method;
-    log["path"] = path;
-    log["status"] = status;
-    log["remote_addr"] = remoteAddr;
-    log["remote_port"] = remotePort;
-    if (duration_ms >= 0) {
-      log["duration_ms"] = duration_ms;
+// Answer a request the solver pool cannot take right now
+void rejectBusy(httplib::Response& res, const std::string& message) {
+  res.status = 503;
+  res.set_header("Retry-After",
+                 std::to_string(g_solverPool->retryAfterSeconds()));
+  json error;
+  error["error"] = message;
+  res.set_content(error.dump(), "application/json");
+}
+
+// HTTP status and message for a solve that produced no usable plan, or 0
+int solutionError(const Solution& solution, std::string& error) {
+  if (solution.status == "infeasible") {
+    Logger::log(Logger::WARN,
+                "Optimization infeasible with the available stock");
+    error = "Not enough stock available for the cuts";
+    return 422;
+  }
+  if (solution.num_sticks == 0) {
+    Logger::log(Logger::ERROR, "Optimization failed - no solution found");
+    error = "No solution found";
+    return 500;
+  }
+  return 0;
+}
+
+// The fields of a solved request's response other than the solution: the
+// request settings, timing and cuts summary. Callers add the solution last,
+// so its patterns can stream out after everything else.
+void writeResponseFields(JsonWriter& out, const OptimizeRequest& request,
+                         double seconds, bool cacheHit) {
+  const LengthUnits units = request.options.units;
+  out.field("jobName", request.jobName);
+  out.field("materialType", request.materialType);
+  out.field("units", unitsName(units));
+  out.field("stockLength", toUnits(request.stockLen, units));
+  out.field("stockLengthPretty", prettyLen(request.stockLen, units));
+  out.field("kerf", toUnits(request.kerf, units));
+  out.field("kerfPretty", units == LengthUnits::Inches
+                              ? toFraction(request.kerf)
+                              : prettyLen(request.kerf, units));
+  out.field("mode", request.modeStr);
+  out.field("quality", request.qualityStr);
+  out.field("optimizationTime", seconds);
+  out.field("cached", cacheHit);
+
+  // Group cuts by length for summary, with the labels given for each
+  struct LengthSummary {
+    long long quantity{0};
+    std::vector<std::string> labels;
+  };
+  std::map<double, LengthSummary> cutCounts;
+  for (const auto& entry : request.demands) {
+    LengthSummary& summary = cutCounts[entry.length];
+    summary.quantity += entry.quantity;
+    if (!entry.label.empty() &&
+        std::find(summary.labels.begin(), summary.labels.end(),
+                  entry.label) == summary.labels.end()) {
+      summary.labels.push_back(entry.label);
     }
-    std::cout << log.dump() << std::endl;
   }
-};
 
-// Read file content
-std::string readFile(const std::string& path) {
-  std::ifstream file(path);
-  if (!file.is_open()) {
-    // Try alternate path (useful for Docker deployments)
-    std::string altPath = "/app/" + path;
-    file.open(altPath);
-    if (!file.is_open()) {
-      return "";
+  out.key("cutsSummary");
+  out.beginArray();
+  for (auto it = cutCounts.rbegin(); it != cutCounts.rend(); ++it) {
+    out.beginObject();
+    out.field("length", toUnits(it->first, units));
+    out.field("lengthPretty", prettyLen(it->first, units));
+    out.field("quantity", it->second.quantity);
+    if (!it->second.labels.empty()) {
+      out.key("labels");
+      out.beginArray();
+      for (const auto& label : it->second.labels) {
+        out.value(label);
+      }
+      out.endArray();
     }
+    out.endObject();
+  }
+  out.endArray();
+}
+
+// The "sawPlan" field, when there is a plan
+void writeSawPlanField(JsonWriter& out, const SawPlan* plan) {
+  if (plan == nullptr)
+    return;
+  out.key("sawPlan");
+  writeSawPlan(out, *plan);
+}
+
+// The "sticks" field, when the request asks for it. The ids are laid out
+// from the request's own demands, since the solution may be a cached or
+// shared one solved for an identical job listing its cuts in another order.
+void writeSticksField(JsonWriter& out, const OptimizeRequest& request,
+                      const Solution& solution) {
+  if (!request.sticks)
+    return;
+  out.key("sticks");
+  writeSticks(out, solution, demandIds(solution, request.demands),
+              request.entries, request.options.units);
+}
+
+// Full response object for a solved request, appended to `out`. Progress
+// events pass no saw plan, which only the final solution is worth.
+void writeResponse(JsonWriter& out, const OptimizeRequest& request,
+                   const Solution& solution, const SawPlan* plan,
+                   double seconds, bool cacheHit) {
+  SolutionWriter writer(solution, request.stock, request.options.units);
+  out.buffer().reserve(out.buffer().size() + writer.sizeHint());
+  out.beginObject();
+  writeResponseFields(out, request, seconds, cacheHit);
+  writeSawPlanField(out, plan);
+  writeSticksField(out, request, solution);
+  out.key("solution");
+  writer.write(out);
+  out.endObject();
+}
+
+// Full response document for a solved request
+std::string renderResponse(const OptimizeRequest& request,
+                           const Solution& solution, const SawPlan* plan,
+                           double seconds, bool cacheHit) {
+  std::string text;
+  JsonWriter out(text);
+  writeResponse(out, request, solution, plan, seconds, cacheHit);
+  return text;
+}
+
+void logStart(const OptimizeRequest& request) {
+  if (!Logger::enabled(Logger::INFO))
+    return;
+  std::stringstream logMsg;
+  logMsg << "Starting optimization - Job: " << request.jobName
+         << ", Stock: " << request.stock.size() << " type(s) up to "
+         << request.stockLen << "\", Kerf: " << request.kerf
+         << "\", Total cuts: " << request.pieces
+         << ", Mode: " << request.modeStr;
+  Logger::log(Logger::INFO, logMsg.str());
+}
+
+void logComplete(const Solution& solution, double milliseconds,
+                 bool cacheHit) {
+  if (!Logger::enabled(Logger::INFO))
+    return;
+  std::stringstream logMsg;
+  logMsg << "Optimization complete - Sticks: " << solution.num_sticks
+         << ", Cost: " << solution.total_cost << " (" << solution.status
+         << ", gap " << solution.mip_gap
+         << "), Waste: " << solution.total_waste
+         << "\", Time: " << milliseconds << "ms"
+         << (cacheHit ? " (cached)" : "");
+  const SolveStats& stats = solution.stats;
+  if (!cacheHit) {
+    logMsg << ", Phases: heuristics " << stats.heuristic_ms << "ms, patterns "
+           << stats.pattern_ms << "ms (" << stats.columns
+           << " columns), model " << stats.model_ms << "ms, MIP "
+           << stats.mip_ms << "ms (" << stats.mip_nodes << " nodes, "
+           << stats.lp_iterations << " iterations)";
+  }
+  Logger::log(Logger::INFO, logMsg.str());
+}
+
+// Write a {"error": ...} response
+void sendError(httplib::Response& res, int status, const std::string& message) {
+  json error;
+  error["error"] = message;
+  res.status = status;
+  res.set_content(error.dump(), "application/json");
+}
+
+// Answer 400 for a request that failed validation, and log why
+void rejectInvalid(httplib::Response& res, const std::string& error) {
+  Logger::log(Logger::WARN, "Invalid request: " + error);
+  sendError(res, 400, error);
+}
+
+// Seconds from a point in time until now
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  std::chrono::duration<double> taken =
+      std::chrono::steady_clock::now() - start;
+  return taken.count();
+}
+
+// Key of the saw plan for a job under a request's saw settings. The search
+// threads are left out, being the same for every request.
+JobSignature sawPlanSignature(const JobSignature& job,
+                              const SawSettings& saws) {
+  JobSignature key = job;
+  key.words.push_back(saws.saws);
+  key.words.push_back(saws.maxOpenStacks);
+  for (double seconds : {saws.stickSeconds, saws.cutSeconds,
+                         saws.setupSeconds, saws.timeBudgetMs}) {
+    long long bits;
+    std::memcpy(&bits, &seconds, sizeof bits);
+    key.words.push_back(bits);
+  }
+  key.hash = hashWords(key.words);
+  return key;
+}
+
+// The plan cached for this very solution under these saw settings, or null
+std::shared_ptr<const SawPlan>
+cachedSawPlan(const JobSignature& job,
+              const std::shared_ptr<const Solution>& solution,
+              const SawSettings& saws) {
+  SawPlanEntry entry;
+  if (g_sawPlanCache->get(sawPlanSignature(job, saws), entry) &&
+      entry.solution == solution)
+    return entry.plan;
+  return nullptr;
+}
+
+// Keep a plan for its solution, which must be the one in the solution cache
+void cacheSawPlan(const JobSignature& job,
+                  const std::shared_ptr<const Solution>& solution,
+                  const SawSettings& saws,
+                  std::shared_ptr<const SawPlan> plan) {
+  if (plan && solution->num_sticks > 0) {
+    g_sawPlanCache->put(sawPlanSignature(job, saws),
+                        {solution, std::move(plan)});
   }
-  std::stringstream buffer;
-  buffer << file.rdbuf();
-  return buffer.str();
 }
 
-// Convert Solution to JSON for API response
-json solutionToJson(const Solution& solution, double stockLen, double kerf) {
-  json result;
-  result["num_sticks"] = solution.num_sticks;
-  result["total_waste"] = solution.total_waste;
-
-  double totalStock = solution.num_sticks * stockLen;
-  result["efficiency"] =
-      totalStock > 0 ? (totalStock - solution.total_waste) / totalStock * 100.0
-                     : 0.0;
-
-  // Group patterns
-  auto patterns = groupPatterns(solution.sticks);
-  json patternsJson = json::array();
-
-  for (const auto& p : patterns) {
-    json pattern;
-    pattern["count"] = p.count;
-    pattern["used_len"] = p.used_len;
-    pattern["waste_len"] = p.waste_len;
-
-    json cutsJson = json::array();
-    for (const auto& cut : p.cuts) {
-      json cutJson;
-      cutJson["length"] = cut.length;
-      cutJson["pretty_length"] = prettyLen(cut.length);
-      cutsJson.push_back(cutJson);
+// Sequence a solution on the saws, recording the time as its own phase.
+// Called on a solver thread, so the search threads come out of the cores
+// that thread is given, as an enumeration's do.
+std::shared_ptr<const SawPlan> planSawsTimed(const Solution& solution,
+                                             const SawSettings& saws) {
+  auto start = std::chrono::steady_clock::now();
+  auto plan = std::make_shared<const SawPlan>(planSaws(solution, saws));
+  g_metrics.observePhase(Phase::Sequencing, secondsSince(start));
+  return plan;
+}
+
+// Where a pool job leaves the saw plan it made, for the thread that waits
+// on its future
+using SawPlanSlot = std::shared_ptr<std::shared_ptr<const SawPlan>>;
+
+// Run the optimizer on a request, recording its phases in the metrics, and
+// plan the saws into `plan` when given one and the request asks for it
+Solution solveRequest(const OptimizeRequest& request,
+                      const SawPlanSlot& plan = nullptr) {
+  Solution solution = optimizeCutting(request.demands, request.stock,
+                                      request.kerf, request.options);
+  g_metrics.observeSolve(solution);
+  if (plan && request.saws.saws > 0 && solution.num_sticks > 0) {
+    *plan = planSawsTimed(solution, request.saws);
+  }
+  return solution;
+}
+
+// The saw plan for a cached solution: the one made for it before under the
+// request's settings, else one made on the solver pool, waiting at most the
+// request's queue limit for a thread. Null when the pool cannot take it.
+std::shared_ptr<const SawPlan>
+planCachedSolution(const JobSignature& job,
+                   const std::shared_ptr<const Solution>& solution,
+                   const OptimizeRequest& request) {
+  std::shared_ptr<const SawPlan> cached =
+      cachedSawPlan(job, solution, request.saws);
+  if (cached)
+    return cached;
+  auto plan = std::make_shared<std::shared_ptr<const SawPlan>>();
+  SawSettings saws = request.saws;
+  std::future<Solution> pending;
+  uint64_t ticket = g_solverPool->submit(
+      [solution, saws, plan] {
+        *plan = planSawsTimed(*solution, saws);
+        return Solution();
+      },
+      request.maxQueueMs, pending);
+  if (ticket == 0)
+    return nullptr;
+  if (request.maxQueueMs > 0 &&
+      pending.wait_for(std::chrono::duration<double, std::milli>(
+          request.maxQueueMs)) != std::future_status::ready &&
+      g_solverPool->withdraw(ticket))
+    return nullptr;
+  try {
+    pending.get();
+  } catch (const QueueTimeout&) {
+    return nullptr;
+  }
+  cacheSawPlan(job, solution, saws, *plan);
+  return *plan;
+}
+
+// Solve a parsed request, or answer from the cache, and write the response:
+// the plan, or a 4xx/5xx error when no plan came out. `received` is when
+// the request arrived, for the request time metric.
+void solveAndRespond(const OptimizeRequest& request, httplib::Response& res,
+                     std::chrono::steady_clock::time_point received) {
+  std::string error;
+  logStart(request);
+
+  // Run optimization, unless an identical job was solved recently
+  auto startTime = std::chrono::high_resolution_clock::now();
+  JobSignature signature = makeJobSignature(request.demands, request.stock,
+                                            request.kerf, request.options);
+  std::shared_ptr<const Solution> cached;
+  std::shared_ptr<const SawPlan> plan;
+  bool cacheHit = g_solutionCache->get(signature, cached);
+  if (!cacheHit) {
+    // Solve on the pool; give up on a job that is still queued when
+    // this request's wait limit runs out
+    std::future<Solution> pending;
+    auto planned = std::make_shared<std::shared_ptr<const SawPlan>>();
+    uint64_t ticket = g_solverPool->submit(
+        [request, planned] { return solveRequest(request, planned); },
+        request.maxQueueMs, pending);
+    if (ticket == 0) {
+      Logger::log(Logger::WARN, "Solver queue full, rejecting job");
+      rejectBusy(res, "Server busy, try again later");
+      return;
+    }
+    if (request.maxQueueMs > 0 &&
+        pending.wait_for(std::chrono::duration<double, std::milli>(
+            request.maxQueueMs)) != std::future_status::ready &&
+        g_solverPool->withdraw(ticket)) {
+      Logger::log(Logger::WARN, "Job timed out waiting for a solver");
+      rejectBusy(res, "Timed out waiting for a solver");
+      return;
+    }
+    try {
+      cached = std::make_shared<const Solution>(pending.get());
+    } catch (const QueueTimeout&) {
+      rejectBusy(res, "Timed out waiting for a solver");
+      return;
+    }
+    plan = *planned;
+    if (cached->num_sticks > 0) {
+      g_solutionCache->put(signature, cached);
+      cacheSawPlan(signature, cached, request.saws, plan);
     }
-    pattern["cuts"] = cutsJson;
-    patternsJson.push_back(pattern);
   }
+  const Solution& solution = *cached;
+  auto endTime = std::chrono::high_resolution_clock::now();
+
+  auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+      endTime - startTime);
 
-  result["patterns"] = patternsJson;
-  return result;
+  if (int status = solutionError(solution, error)) {
+    sendError(res, status, error);
+    return;
+  }
+  if (request.saws.saws > 0 && !plan) {
+    plan = planCachedSolution(signature, cached, request);
+    if (!plan) {
+      Logger::log(Logger::WARN, "Solver queue full, rejecting saw plan");
+      rejectBusy(res, "Server busy, try again later");
+      return;
+    }
+  }
+  logComplete(solution, duration.count() / 1000.0, cacheHit);
+
+  // A solution has at least as many runs as patterns; one with many goes
+  // out a batch of patterns per chunk as the client reads it, so only one
+  // batch is ever in memory
+  double grouping = 0.0;
+  auto phaseStart = std::chrono::steady_clock::now();
+  // A streamed response writes its opening fields through the stream's own
+  // writer, which then still has the outer object open when the last chunk
+  // closes it
+  bool streamed = solution.runs.size() > g_streamPatterns;
+  std::shared_ptr<ResponseStream> stream;
+  if (streamed)
+    stream = std::make_shared<ResponseStream>();
+  std::string text;
+  JsonWriter local(text);
+  JsonWriter& out = streamed ? stream->out : local;
+  out.beginObject();
+  writeResponseFields(out, request, duration.count() / 1e6, cacheHit);
+  writeSawPlanField(out, plan.get());
+  writeSticksField(out, request, solution);
+  out.key("solution");
+  if (!streamed) {
+    auto groupStart = std::chrono::steady_clock::now();
+    SolutionWriter writer(solution, request.stock, request.options.units);
+    grouping = secondsSince(groupStart);
+    text.reserve(text.size() + writer.sizeHint());
+    writer.write(out);
+    out.endObject();
+    res.set_content(std::move(text), "application/json");
+  } else {
+    // The stream keeps the solution and stock alive for the writer
+    stream->solution = cached;
+    stream->stock = request.stock;
+    auto groupStart = std::chrono::steady_clock::now();
+    stream->writer = std::make_unique<SolutionWriter>(
+        *stream->solution, stream->stock, request.options.units);
+    grouping = secondsSince(groupStart);
+    stream->writer->begin(stream->out);
+    res.set_chunked_content_provider(
+        "application/json", [stream](size_t, httplib::DataSink& sink) {
+          bool more = stream->writer->next(stream->out, kStreamBatch);
+          if (!more) {
+            stream->writer->end(stream->out);
+            stream->out.endObject();
+          }
+          if (!sink.write(stream->buffer.data(), stream->buffer.size()))
+            return false;
+          stream->buffer.clear();
+          if (!more)
+            sink.done();
+          return true;
+        });
+  }
+  g_metrics.observePhase(Phase::Grouping, grouping);
+  g_metrics.observePhase(Phase::Serialize,
+                         secondsSince(phaseStart) - grouping);
+  g_metrics.observeRequest(secondsSince(received));
 }
 
 int main() {
@@ -133,20 +574,79 @@ int main() {
   signal(SIGINT, signalHandler);
   signal(SIGTERM, signalHandler);
 
-  // Check for static files
-  std::string indexContent = readFile("static/index.html");
-  if (indexContent.empty()) {
-    Logger::log(Logger::WARN,
-                "static/index.html not found in current directory");
-    Logger::log(Logger::INFO,
-                "Will try /app/static/index.html when requests come in");
+  // Log lines go through a background writer from here on
+  Logger::Level logLevel;
+  const char* logLevelName = std::getenv("NESTING_LOG_LEVEL");
+  if (logLevelName != nullptr && Logger::parseLevel(logLevelName, logLevel)) {
+    Logger::setLevel(logLevel);
+  }
+  Logger::start(static_cast<size_t>(envOr("NESTING_LOG_BUFFER", 8192)));
+
+  g_limits.patternBudget.maxPatterns = static_cast<size_t>(
+      envOr("NESTING_MAX_PATTERNS", g_limits.patternBudget.maxPatterns));
+  g_limits.patternBudget.maxMillis =
+      envOr("NESTING_PATTERN_TIME_MS", g_limits.patternBudget.maxMillis);
+  g_limits.maxTimeLimitMs =
+      envOr("NESTING_MAX_TIME_LIMIT_MS", g_limits.maxTimeLimitMs);
+  g_limits.maxSequenceMs =
+      envOr("NESTING_MAX_SEQUENCE_MS", g_limits.maxSequenceMs);
+  g_solutionCache = std::make_unique<SolutionCache>(
+      static_cast<size_t>(envOr("NESTING_CACHE_SIZE", 256)),
+      envOr("NESTING_CACHE_TTL_S", 3600));
+  g_sawPlanCache = std::make_unique<SawPlanCache>(
+      static_cast<size_t>(envOr("NESTING_CACHE_SIZE", 256)),
+      envOr("NESTING_CACHE_TTL_S", 3600));
+
+  size_t solverThreads = static_cast<size_t>(
+      envOr("NESTING_SOLVER_THREADS",
+            std::max(1u, std::thread::hardware_concurrency())));
+  size_t solverQueue =
+      static_cast<size_t>(envOr("NESTING_SOLVER_QUEUE", 2 * solverThreads));
+  g_limits.maxQueueMs =
+      envOr("NESTING_QUEUE_TIMEOUT_MS", g_limits.maxQueueMs);
+  g_solverPool = std::make_unique<SolverPool>(solverThreads, solverQueue);
+  // Share the cores between the solver threads by default, so a full pool
+  // does not oversubscribe them
+  size_t coresPerSolver = std::thread::hardware_concurrency() / solverThreads;
+  g_limits.enumerationThreads = static_cast<unsigned>(
+      envOr("NESTING_ENUM_THREADS", std::max<size_t>(1, coresPerSolver)));
+  g_jobStore = std::make_unique<JobStore>(
+      static_cast<size_t>(envOr("NESTING_MAX_JOBS", 1000)),
+      envOr("NESTING_JOB_TTL_S", 3600));
+  g_maxStreams =
+      static_cast<size_t>(envOr("NESTING_MAX_STREAMS", g_maxStreams));
+  g_maxBatch = static_cast<size_t>(envOr("NESTING_MAX_BATCH", g_maxBatch));
+  g_streamPatterns = static_cast<size_t>(
+      envOr("NESTING_STREAM_PATTERNS", g_streamPatterns));
+
+  // Load the web UI, from the working directory or the Docker image
+  g_staticAssets = std::make_unique<StaticAssets>(
+      std::vector<std::string>{"static", "/app/static"},
+      envOr("NESTING_STATIC_RELOAD", 0) != 0);
+  g_staticCacheControl =
+      "public, max-age=" +
+      std::to_string(static_cast<long>(envOr("NESTING_STATIC_MAX_AGE_S", 600)));
+  if (g_staticAssets->root().empty()) {
+    Logger::log(Logger::WARN, "No static directory found; the web UI is "
+                              "unavailable");
   } else {
-    Logger::log(Logger::INFO, "Static files found in current directory");
+    Logger::log(Logger::INFO,
+                "Loaded " + std::to_string(g_staticAssets->size()) +
+                    " static files from " + g_staticAssets->root());
   }
 
   httplib::Server svr;
   g_svr = &svr; // Store global reference for signal handler
 
+  // Every solve holds its connection thread while it waits, and so does
+  // every event stream, so keep enough threads for a full pool, queue and
+  // stream allowance plus spare ones for the fast routes
+  size_t httpThreads = solverThreads + solverQueue + g_maxStreams +
+                       static_cast<size_t>(envOr("NESTING_HTTP_THREADS", 8));
+  svr.new_task_queue = [httpThreads] {
+    return new httplib::ThreadPool(httpThreads);
+  };
+
   // Set up request logging
   svr.set_logger([](const httplib::Request& req, const httplib::Response& res) {
     Logger::logRequest(req.method, req.path, res.status,
@@ -155,45 +655,15 @@ int main() {
 
   // Note: CORS headers will be set in each handler
 
-  // Serve the main page
+  // Serve the main page; always revalidated so a deploy shows up at once
   svr.Get("/", [](const httplib::Request& req, httplib::Response& res) {
-    std::string content = readFile("static/index.html");
-    if (content.empty()) {
-      Logger::log(Logger::ERROR,
-                  "Failed to read static/index.html - file not found");
-      res.status = 404;
-      res.set_content("<h1>404 - File Not Found</h1><p>Could not find "
-                      "index.html. Please check your deployment.</p>",
-                      "text/html");
-    } else {
-      res.set_content(content, "text/html");
-    }
+    serveAsset(req, res, "index.html", "no-cache");
   });
 
   // Serve static files
   svr.Get("/static/(.*)",
           [](const httplib::Request& req, httplib::Response& res) {
-            std::string path = "static/" + req.matches[1].str();
-            std::string content = readFile(path);
-            if (content.empty()) {
-              Logger::log(Logger::WARN, "Static file not found: " + path);
-              res.status = 404;
-              res.set_content("File not found", "text/plain");
-            } else {
-              // Set appropriate content type based on extension
-              std::string ext = path.substr(path.find_last_of(".") + 1);
-              std::string content_type = "text/plain";
-              if (ext == "html")
-                content_type = "text/html";
-              else if (ext == "css")
-                content_type = "text/css";
-              else if (ext == "js")
-                content_type = "application/javascript";
-              else if (ext == "json")
-                content_type = "application/json";
-
-              res.set_content(content, content_type);
-            }
+            serveAsset(req, res, req.matches[1].str(), g_staticCacheControl);
           });
 
   // Health check endpoint
@@ -202,9 +672,124 @@ int main() {
             res.set_content("{\"status\":\"ok\"}", "application/json");
           });
 
+  // Solution cache statistics
+  svr.Get("/api/cache",
+          [](const httplib::Request& req, httplib::Response& res) {
+            auto stats = g_solutionCache->stats();
+            json result;
+            result["hits"] = stats.hits;
+            result["misses"] = stats.misses;
+            uint64_t lookups = stats.hits + stats.misses;
+            result["hit_rate"] =
+                lookups > 0 ? static_cast<double>(stats.hits) / lookups : 0.0;
+            result["size"] = stats.size;
+            result["capacity"] = stats.capacity;
+
+            auto patternStats = patternCacheStats();
+            json patterns;
+            patterns["hits"] = patternStats.hits;
+            patterns["misses"] = patternStats.misses;
+            patterns["size"] = patternStats.size;
+            patterns["capacity"] = patternStats.capacity;
+            result["patterns"] = patterns;
+
+            auto modelStats = modelCacheStats();
+            json models;
+            models["hits"] = modelStats.hits;
+            models["misses"] = modelStats.misses;
+            models["size"] = modelStats.size;
+            models["capacity"] = modelStats.capacity;
+            result["models"] = models;
+            res.set_content(result.dump(), "application/json");
+          });
+
+  // Solver pool load
+  svr.Get("/api/pool",
+          [](const httplib::Request& req, httplib::Response& res) {
+            auto stats = g_solverPool->stats();
+            json result;
+            result["threads"] = stats.threads;
+            result["capacity"] = stats.capacity;
+            result["queued"] = stats.queued;
+            result["running"] = stats.running;
+            result["accepted"] = stats.accepted;
+            result["rejected"] = stats.rejected;
+            result["expired"] = stats.expired;
+            res.set_content(result.dump(), "application/json");
+          });
+
+  // Everything above plus the phase histograms, for Prometheus to scrape
+  svr.Get("/api/metrics",
+          [](const httplib::Request& req, httplib::Response& res) {
+            std::string out;
+            g_metrics.write(out);
+
+            auto pool = g_solverPool->stats();
+            writeMetricHeader(out, "nesting_solver_queue_depth", "gauge",
+                              "Solves waiting for a solver thread");
+            writeSample(out, "nesting_solver_queue_depth", "", pool.queued);
+            writeMetricHeader(out, "nesting_solves_in_flight", "gauge",
+                              "Solves running on the solver threads");
+            writeSample(out, "nesting_solves_in_flight", "", pool.running);
+            writeMetricHeader(out, "nesting_solver_threads", "gauge",
+                              "Size of the solver pool");
+            writeSample(out, "nesting_solver_threads", "", pool.threads);
+            writeMetricHeader(out, "nesting_solver_jobs_total", "counter",
+                              "Jobs offered to the solver pool, by outcome");
+            writeSample(out, "nesting_solver_jobs_total",
+                        "outcome=\"accepted\"", pool.accepted);
+            writeSample(out, "nesting_solver_jobs_total",
+                        "outcome=\"rejected\"", pool.rejected);
+            writeSample(out, "nesting_solver_jobs_total",
+                        "outcome=\"expired\"", pool.expired);
+
+            auto cache = g_solutionCache->stats();
+            uint64_t lookups = cache.hits + cache.misses;
+            writeMetricHeader(out, "nesting_cache_lookups_total", "counter",
+                              "Solution cache lookups, by result");
+            writeSample(out, "nesting_cache_lookups_total",
+                        "result=\"hit\"", cache.hits);
+            writeSample(out, "nesting_cache_lookups_total",
+                        "result=\"miss\"", cache.misses);
+            writeMetricHeader(out, "nesting_cache_hit_ratio", "gauge",
+                              "Share of solution cache lookups answered");
+            writeSample(out, "nesting_cache_hit_ratio", "",
+                        lookups > 0 ? static_cast<double>(cache.hits) /
+                                          lookups
+                                    : 0.0);
+            writeMetricHeader(out, "nesting_cache_entries", "gauge",
+                              "Solutions held in the cache");
+            writeSample(out, "nesting_cache_entries", "", cache.size);
+
+            auto arena = scratchStats();
+            writeMetricHeader(out, "nesting_scratch_bytes", "gauge",
+                              "Scratch arena memory kept by solver threads");
+            writeSample(out, "nesting_scratch_bytes", "",
+                        static_cast<double>(arena.reservedBytes));
+            writeMetricHeader(out, "nesting_scratch_resets_total", "counter",
+                              "Scratch arena resets, by whether the request "
+                              "fit in the kept memory");
+            writeSample(out, "nesting_scratch_resets_total",
+                        "outcome=\"fit\"",
+                        static_cast<double>(arena.resets - arena.overflows));
+            writeSample(out, "nesting_scratch_resets_total",
+                        "outcome=\"overflow\"",
+                        static_cast<double>(arena.overflows));
+
+            writeMetricHeader(out, "nesting_open_streams", "gauge",
+                              "Job event streams being served");
+            writeSample(out, "nesting_open_streams", "", g_openStreams.load());
+            writeMetricHeader(out, "nesting_log_dropped_total", "counter",
+                              "Log lines dropped because the buffer was full");
+            writeSample(out, "nesting_log_dropped_total", "",
+                        static_cast<double>(Logger::dropped()));
+            res.set_content(out, "text/plain; version=0.0.4; charset=utf-8");
+          });
+
   // Handle OPTIONS requests for CORS
   svr.Options(
-      "/api/optimize", [](const httplib::Request& req, httplib::Response& res) {
+      "/api/optimize(/batch|/csv)?",
+      [](const httplib::Request& req, httplib::Response& res) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Methods", "POST, GET, OPTIONS");
         res.set_header("Access-Control-Allow-Headers", "Content-Type");
@@ -219,146 +804,586 @@ int main() {
 
     try {
       Logger::log(Logger::DEBUG, "Parsing optimization request body");
+      auto received = std::chrono::steady_clock::now();
       auto body = json::parse(req.body);
+      g_metrics.observePhase(Phase::JsonParse, secondsSince(received));
+      auto phaseStart = std::chrono::steady_clock::now();
+      OptimizeRequest request;
+      std::string error;
+      if (!parseOptimizeRequest(body, g_limits, request, error)) {
+        rejectInvalid(res, error);
+        return;
+      }
+      g_metrics.observePhase(Phase::LengthParse, secondsSince(phaseStart));
+      solveAndRespond(request, res, received);
 
-      // Extract parameters
-      std::string jobName = body.value("jobName", "Cut Plan");
-      std::string materialType =
-          body.value("materialType", "Standard Material");
-      std::string stockLengthStr = body["stockLength"];
-      std::string kerfStr = body["kerf"];
-      auto cutsArray = body["cuts"];
-
-      // Parse stock length
-      double stockLen = parseAdvancedLength(stockLengthStr);
-      if (stockLen <= 0) {
-        Logger::log(Logger::WARN, "Invalid stock length: " + stockLengthStr);
-        res.status = 400;
-        res.set_content("{\"error\":\"Invalid stock length\"}",
-                        "application/json");
+    } catch (const json::parse_error& e) {
+      Logger::log(Logger::ERROR, "JSON parse error: " + std::string(e.what()));
+      sendError(res, 400, "Invalid JSON format");
+    } catch (const std::exception& e) {
+      Logger::log(Logger::ERROR, "Server error: " + std::string(e.what()));
+      sendError(res, 500, std::string("Server error: ") + e.what());
+    }
+  });
+
+  // Cut list as a raw CSV/TSV body, with the stock and options in the query
+  // string. The body is parsed as it arrives, never held whole.
+  svr.Post("/api/optimize/csv", [](const httplib::Request& req,
+                                   httplib::Response& res,
+                                   const httplib::ContentReader& reader) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+
+    try {
+      auto received = std::chrono::steady_clock::now();
+      json settings;
+      settings["kerf"] = "";
+      for (const char* name :
+           {"jobName", "materialType", "units", "stockLength", "kerf", "mode",
+            "quality", "offcutThreshold"}) {
+        if (req.has_param(name))
+          settings[name] = req.get_param_value(name);
+      }
+      if (!req.has_param("stockLength")) {
+        sendError(res, 400, "Missing stockLength parameter");
         return;
       }
+      for (const char* name :
+           {"timeLimitMs", "mipGap", "maxQueueMs", "saws"}) {
+        if (!req.has_param(name))
+          continue;
+        try {
+          settings[name] = std::stod(req.get_param_value(name));
+        } catch (const std::exception&) {
+          sendError(res, 400, std::string("Invalid ") + name);
+          return;
+        }
+      }
+      for (const char* name : {"maximalPatterns", "sticks"}) {
+        if (!req.has_param(name))
+          continue;
+        std::string flag = req.get_param_value(name);
+        settings[name] = flag == "true" || flag == "1";
+      }
 
-      // Parse kerf
-      double kerf = parseFraction(kerfStr);
-      if (kerf <= 0) {
-        kerf = 0.125; // Default to 1/8"
-        Logger::log(Logger::INFO, "Using default kerf: 1/8\"");
+      OptimizeRequest request;
+      std::string error;
+      if (!parseSolveSettings(settings, g_limits, request, error)) {
+        rejectInvalid(res, error);
+        return;
       }
 
-      // Parse cuts
-      std::vector<Cut> cuts;
-      int cutID = 1;
-      int totalCuts = 0;
+      // The body is parsed as it streams in, so this also times the upload
+      auto phaseStart = std::chrono::steady_clock::now();
+      CutListReader cutList(request.options.units);
+      reader([&cutList](const char* data, size_t length) {
+        return cutList.feed(std::string_view(data, length));
+      });
+      if (!cutList.finish()) {
+        Logger::log(Logger::WARN, "Invalid cut list: " + cutList.error());
+        sendError(res, 400, "Invalid cut list: " + cutList.error());
+        return;
+      }
+      for (const auto& item : cutList.items()) {
+        if (!addCuts(request, item.length, item.quantity, item.label,
+                     error)) {
+          rejectInvalid(res, error);
+          return;
+        }
+      }
+      if (request.demands.empty()) {
+        sendError(res, 400, "No valid cuts provided");
+        return;
+      }
+      g_metrics.observePhase(Phase::LengthParse, secondsSince(phaseStart));
+      solveAndRespond(request, res, received);
+
+    } catch (const std::exception& e) {
+      Logger::log(Logger::ERROR, "Server error: " + std::string(e.what()));
+      sendError(res, 500, std::string("Server error: ") + e.what());
+    }
+  });
+
+  // Many jobs in one request: identical jobs are solved once, the rest run
+  // side by side on the solver pool
+  svr.Post("/api/optimize/batch", [](const httplib::Request& req,
+                                     httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
 
-      for (const auto& cutItem : cutsArray) {
-        double length =
-            parseAdvancedLength(cutItem["length"].get<std::string>());
-        int quantity = cutItem["quantity"].get<int>();
+    try {
+      auto body = json::parse(req.body);
+      if (!body.contains("jobs") || !body["jobs"].is_array()) {
+        sendError(res, 400, "Expected a \"jobs\" array");
+        return;
+      }
+      const json& jobs = body["jobs"];
+      if (jobs.size() > g_maxBatch) {
+        sendError(res, 413,
+                  "Too many jobs in one batch (max " +
+                      std::to_string(g_maxBatch) + ")");
+        return;
+      }
+      auto startTime = std::chrono::steady_clock::now();
+      auto secondsSinceStart = [&startTime] {
+        std::chrono::duration<double> taken =
+            std::chrono::steady_clock::now() - startTime;
+        return taken.count();
+      };
 
-        if (length <= 0 || quantity <= 0) {
-          Logger::log(Logger::WARN,
-                      "Skipping invalid cut: length=" + std::to_string(length) +
-                          ", qty=" + std::to_string(quantity));
+      // Parse every job and group them by signature
+      const size_t numJobs = jobs.size();
+      std::vector<OptimizeRequest> requests(numJobs);
+      std::vector<std::string> jobError(numJobs);
+      std::vector<size_t> uniqueOf(numJobs, 0);
+      std::vector<JobSignature> signatures;
+      std::vector<size_t> representative;
+      std::unordered_map<JobSignature, size_t, JobSignatureHash> seen;
+      for (size_t i = 0; i < numJobs; i++) {
+        try {
+          if (!parseOptimizeRequest(jobs[i], g_limits, requests[i],
+                                    jobError[i]))
+            continue;
+        } catch (const std::exception& e) {
+          jobError[i] = std::string("Invalid job: ") + e.what();
           continue;
         }
+        JobSignature signature =
+            makeJobSignature(requests[i].demands, requests[i].stock,
+                             requests[i].kerf, requests[i].options);
+        auto inserted = seen.emplace(signature, signatures.size());
+        if (inserted.second) {
+          signatures.push_back(std::move(signature));
+          representative.push_back(i);
+        }
+        uniqueOf[i] = inserted.first->second;
+      }
 
-        if (length > stockLen) {
-          Logger::log(Logger::ERROR,
-                      "Cut length exceeds stock: " + std::to_string(length) +
-                          " > " + std::to_string(stockLen));
-          res.status = 400;
-          res.set_content("{\"error\":\"Cut length exceeds stock length\"}",
-                          "application/json");
-          return;
+      const size_t numUnique = signatures.size();
+      std::vector<std::shared_ptr<const Solution>> solved(numUnique);
+      std::vector<bool> cacheHit(numUnique, false);
+      std::vector<double> solvedAt(numUnique, 0.0);
+      std::vector<std::string> solveError(numUnique);
+      for (size_t u = 0; u < numUnique; u++) {
+        cacheHit[u] = g_solutionCache->get(signatures[u], solved[u]);
+      }
+
+      // Keep at most one job per solver thread in flight, so the batch keeps
+      // every core busy without taking all the queue slots other clients
+      // need. Finished jobs are collected oldest first.
+      struct InFlight {
+        std::future<Solution> result;
+        std::function<void(std::future<Solution>&)> finish;
+      };
+      std::deque<InFlight> inFlight;
+      const size_t window = g_solverPool->stats().threads;
+      auto collect = [&]() {
+        InFlight job = std::move(inFlight.front());
+        inFlight.pop_front();
+        job.finish(job.result);
+      };
+      // Queue a job on the pool, returning false when it stayed full for
+      // `maxQueueMs`
+      auto submit = [&](const std::function<Solution()>& job,
+                        double maxQueueMs,
+                        std::function<void(std::future<Solution>&)> finish) {
+        while (inFlight.size() >= window) {
+          collect();
+        }
+        auto retryUntil = std::chrono::steady_clock::now() +
+                          std::chrono::duration_cast<
+                              std::chrono::steady_clock::duration>(
+                              std::chrono::duration<double, std::milli>(
+                                  maxQueueMs));
+        std::future<Solution> pending;
+        while (g_solverPool->submit(job, 0, pending) == 0) {
+          // Queue full: wait for our own work first, then for other clients'
+          if (!inFlight.empty()) {
+            collect();
+          } else if (std::chrono::steady_clock::now() < retryUntil) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+          } else {
+            return false;
+          }
         }
+        inFlight.push_back({std::move(pending), std::move(finish)});
+        return true;
+      };
 
-        for (int i = 0; i < quantity; i++) {
-          cuts.push_back(Cut(length, cutID++));
-          totalCuts++;
+      // Each solve also plans the saws for the job it was solved for
+      std::vector<SawPlanSlot> solvedPlan(numUnique);
+      for (size_t u = 0; u < numUnique; u++) {
+        if (cacheHit[u])
+          continue;
+        const OptimizeRequest& request = requests[representative[u]];
+        SawPlanSlot planned = solvedPlan[u] =
+            std::make_shared<std::shared_ptr<const SawPlan>>();
+        bool queued = submit(
+            [request, planned] { return solveRequest(request, planned); },
+            request.maxQueueMs, [&, u](std::future<Solution>& result) {
+              try {
+                solved[u] = std::make_shared<const Solution>(result.get());
+                if (solved[u]->num_sticks > 0) {
+                  g_solutionCache->put(signatures[u], solved[u]);
+                  cacheSawPlan(signatures[u], solved[u],
+                               requests[representative[u]].saws,
+                               *solvedPlan[u]);
+                }
+              } catch (const QueueTimeout& e) {
+                solveError[u] = e.what();
+              } catch (const std::exception& e) {
+                solveError[u] = std::string("Server error: ") + e.what();
+              }
+              solvedAt[u] = secondsSinceStart();
+            });
+        if (!queued) {
+          solveError[u] = "Server busy, try again later";
         }
       }
+      while (!inFlight.empty()) {
+        collect();
+      }
 
-      if (cuts.empty()) {
-        Logger::log(Logger::WARN, "No valid cuts provided");
-        res.status = 400;
-        res.set_content("{\"error\":\"No valid cuts provided\"}",
-                        "application/json");
-        return;
+      // The other jobs asking for a saw plan take it from the cache, or plan
+      // on the pool in the same window, once per solution and settings
+      std::vector<std::shared_ptr<const SawPlan>> plans(numJobs);
+      std::vector<std::string> planError(numJobs);
+      std::vector<size_t> planOf(numJobs);
+      std::unordered_map<JobSignature, size_t, JobSignatureHash> planned;
+      for (size_t i = 0; i < numJobs; i++) {
+        size_t u = uniqueOf[i];
+        planOf[i] = i;
+        if (!jobError[i].empty() || !solved[u] ||
+            solved[u]->num_sticks == 0 || requests[i].saws.saws <= 0)
+          continue;
+        auto inserted =
+            planned.emplace(sawPlanSignature(signatures[u], requests[i].saws),
+                            i);
+        if (!inserted.second) {
+          planOf[i] = inserted.first->second;
+          continue;
+        }
+        if (representative[u] == i && solvedPlan[u] && *solvedPlan[u]) {
+          plans[i] = *solvedPlan[u];
+          continue;
+        }
+        plans[i] = cachedSawPlan(signatures[u], solved[u], requests[i].saws);
+        if (plans[i])
+          continue;
+        std::shared_ptr<const Solution> solution = solved[u];
+        SawSettings saws = requests[i].saws;
+        auto plan = std::make_shared<std::shared_ptr<const SawPlan>>();
+        bool queued = submit(
+            [solution, saws, plan] {
+              *plan = planSawsTimed(*solution, saws);
+              return Solution();
+            },
+            requests[i].maxQueueMs,
+            [&, i, u, plan](std::future<Solution>& result) {
+              try {
+                result.get();
+                plans[i] = *plan;
+                cacheSawPlan(signatures[u], solved[u], requests[i].saws,
+                             plans[i]);
+              } catch (const QueueTimeout& e) {
+                planError[i] = e.what();
+              } catch (const std::exception& e) {
+                planError[i] = std::string("Server error: ") + e.what();
+              }
+            });
+        if (!queued) {
+          planError[i] = "Server busy, try again later";
+        }
+      }
+      while (!inFlight.empty()) {
+        collect();
       }
 
-      // Log optimization parameters
-      std::stringstream logMsg;
-      logMsg << "Starting optimization - Job: " << jobName
-             << ", Stock: " << stockLen << "\", Kerf: " << kerf
-             << "\", Total cuts: " << totalCuts;
-      Logger::log(Logger::INFO, logMsg.str());
-
-      // Run optimization
-      auto startTime = std::chrono::high_resolution_clock::now();
-      Solution solution = optimizeCutting(cuts, stockLen, kerf);
-      auto endTime = std::chrono::high_resolution_clock::now();
-
-      auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-          endTime - startTime);
-
-      if (solution.num_sticks == 0) {
-        Logger::log(Logger::ERROR, "Optimization failed - no solution found");
-        res.status = 500;
-        res.set_content("{\"error\":\"No solution found\"}",
-                        "application/json");
-        return;
+      std::string text;
+      JsonWriter out(text);
+      out.beginObject();
+      out.key("results");
+      out.beginArray();
+      for (size_t i = 0; i < numJobs; i++) {
+        size_t u = uniqueOf[i];
+        std::string error;
+        int status = 0;
+        if (!jobError[i].empty()) {
+          error = jobError[i];
+          status = 400;
+        } else if (!solved[u]) {
+          error = solveError[u];
+          status = 503;
+        } else if ((status = solutionError(*solved[u], error)) == 0 &&
+                   !planError[planOf[i]].empty()) {
+          error = planError[planOf[i]];
+          status = 503;
+        }
+        out.beginObject();
+        if (status != 0) {
+          out.field("error", error);
+          out.field("status", status);
+        } else {
+          SolutionWriter writer(*solved[u], requests[i].stock,
+                                requests[i].options.units);
+          writeResponseFields(out, requests[i], solvedAt[u], cacheHit[u]);
+          if (representative[u] != i) {
+            out.field("duplicateOf", representative[u]);
+          }
+          writeSawPlanField(out, plans[planOf[i]].get());
+          writeSticksField(out, requests[i], *solved[u]);
+          out.key("solution");
+          writer.write(out);
+        }
+        out.endObject();
       }
+      out.endArray();
+      out.field("jobs", numJobs);
+      out.field("unique", numUnique);
+      out.field("optimizationTime", secondsSinceStart());
+      out.endObject();
+      Logger::log(Logger::INFO, "Batch complete - Jobs: " +
+                                    std::to_string(numJobs) + ", Unique: " +
+                                    std::to_string(numUnique));
+      res.set_content(std::move(text), "application/json");
 
-      // Log results
-      logMsg.str("");
-      logMsg << "Optimization complete - Sticks: " << solution.num_sticks
-             << ", Waste: " << solution.total_waste
-             << "\", Time: " << duration.count() << "ms";
-      Logger::log(Logger::INFO, logMsg.str());
-
-      // Prepare response
-      json response;
-      response["jobName"] = jobName;
-      response["materialType"] = materialType;
-      response["stockLength"] = stockLen;
-      response["stockLengthPretty"] = prettyLen(stockLen);
-      response["kerf"] = kerf;
-      response["kerfPretty"] = toFraction(kerf);
-      response["solution"] = solutionToJson(solution, stockLen, kerf);
-      response["optimizationTime"] = duration.count() / 1000.0;
-
-      // Group cuts by length for summary
-      std::map<double, int> cutCounts;
-      for (const auto& cut : cuts) {
-        cutCounts[cut.length]++;
+    } catch (const json::parse_error& e) {
+      Logger::log(Logger::ERROR, "JSON parse error: " + std::string(e.what()));
+      sendError(res, 400, "Invalid JSON format");
+    } catch (const std::exception& e) {
+      Logger::log(Logger::ERROR, "Server error: " + std::string(e.what()));
+      sendError(res, 500, std::string("Server error: ") + e.what());
+    }
+  });
+
+  // Asynchronous jobs: submit, then poll or stream progress
+  svr.Options("/api/jobs.*",
+              [](const httplib::Request& req, httplib::Response& res) {
+                res.set_header("Access-Control-Allow-Origin", "*");
+                res.set_header("Access-Control-Allow-Methods",
+                               "POST, GET, OPTIONS");
+                res.set_header("Access-Control-Allow-Headers", "Content-Type");
+                res.status = 200;
+              });
+
+  svr.Post("/api/jobs", [](const httplib::Request& req,
+                           httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+
+    try {
+      auto body = json::parse(req.body);
+      auto request = std::make_shared<OptimizeRequest>();
+      std::string error;
+      if (!parseOptimizeRequest(body, g_limits, *request, error)) {
+        rejectInvalid(res, error);
+        return;
       }
+      std::shared_ptr<JobRecord> record = g_jobStore->create();
+      if (!record) {
+        Logger::log(Logger::WARN, "Too many unfinished jobs, rejecting job");
+        rejectBusy(res, "Too many jobs in progress");
+        return;
+      }
+      logStart(*request);
+
+      auto startTime = std::chrono::steady_clock::now();
+      JobSignature signature = makeJobSignature(
+          request->demands, request->stock, request->kerf, request->options);
+
+      // Publishes the final document for a solved (or failed) job
+      auto complete = [record, request, startTime](
+                          const Solution& solution, const SawPlan* plan,
+                          bool cacheHit) {
+        std::chrono::duration<double> taken =
+            std::chrono::steady_clock::now() - startTime;
+        std::string error;
+        if (solutionError(solution, error)) {
+          json failure;
+          failure["error"] = error;
+          record->finish(JobState::Failed, failure.dump());
+          return;
+        }
+        logComplete(solution, taken.count() * 1000.0, cacheHit);
+        record->finish(JobState::Done,
+                       renderResponse(*request, solution, plan, taken.count(),
+                                      cacheHit));
+      };
+
+      // Queued jobs have no client waiting on them, so no queue limit
+      std::shared_ptr<const Solution> cached;
+      std::shared_ptr<const SawPlan> plan;
+      std::future<Solution> ignored;
+      uint64_t ticket = 1;
+      if (g_solutionCache->get(signature, cached) &&
+          (request->saws.saws <= 0 ||
+           (plan = cachedSawPlan(signature, cached, request->saws)))) {
+        complete(*cached, plan.get(), true);
+      } else if (cached) {
+        // Solved before, but not planned for these saws
+        ticket = g_solverPool->submit(
+            [record, request, signature, cached, complete] {
+              record->setRunning();
+              std::shared_ptr<const SawPlan> plan;
+              try {
+                plan = planSawsTimed(*cached, request->saws);
+              } catch (const std::exception& e) {
+                json failure;
+                failure["error"] = std::string("Server error: ") + e.what();
+                record->finish(JobState::Failed, failure.dump());
+                throw;
+              }
+              cacheSawPlan(signature, cached, request->saws, plan);
+              complete(*cached, plan.get(), true);
+              return Solution();
+            },
+            0, ignored);
+      } else {
+        // Each improvement is published as a full response so clients can
+        // show the best plan so far. The hook lives inside the request, so
+        // it only holds it weakly.
+        std::weak_ptr<OptimizeRequest> weakRequest = request;
+        request->options.onProgress = [record, weakRequest](
+                                          const SolveProgress& progress) {
+          auto request = weakRequest.lock();
+          if (!request)
+            return;
+          std::string event;
+          JsonWriter out(event);
+          out.beginObject();
+          out.field("elapsed_ms", progress.elapsedMs);
+          out.field("objective", progress.objective);
+          out.field("bound", progress.bound);
+          out.field("gap", progress.gap);
+          if (progress.incumbent) {
+            out.key("response");
+            writeResponse(out, *request, *progress.incumbent, nullptr,
+                          progress.elapsedMs / 1000.0, false);
+          }
+          out.endObject();
+          record->publish("progress", std::move(event));
+        };
 
-      json cutsSum = json::array();
-      for (auto it = cutCounts.rbegin(); it != cutCounts.rend(); ++it) {
-        json item;
-        item["length"] = it->first;
-        item["lengthPretty"] = prettyLen(it->first);
-        item["quantity"] = it->second;
-        cutsSum.push_back(item);
+        ticket = g_solverPool->submit(
+            [record, request, signature, complete] {
+              record->setRunning();
+              Solution solution;
+              auto plan = std::make_shared<std::shared_ptr<const SawPlan>>();
+              try {
+                solution = solveRequest(*request, plan);
+              } catch (const std::exception& e) {
+                json failure;
+                failure["error"] = std::string("Server error: ") + e.what();
+                record->finish(JobState::Failed, failure.dump());
+                throw;
+              }
+              auto shared = std::make_shared<const Solution>(solution);
+              if (shared->num_sticks > 0) {
+                g_solutionCache->put(signature, shared);
+                cacheSawPlan(signature, shared, request->saws, *plan);
+              }
+              complete(*shared, plan->get(), false);
+              return solution;
+            },
+            0, ignored);
+      }
+      if (ticket == 0) {
+        json failure;
+        failure["error"] = "Server busy, try again later";
+        record->finish(JobState::Failed, failure.dump());
+        Logger::log(Logger::WARN, "Solver queue full, rejecting job");
+        rejectBusy(res, "Server busy, try again later");
+        return;
       }
-      response["cutsSummary"] = cutsSum;
 
-      res.set_content(response.dump(), "application/json");
+      json accepted;
+      accepted["id"] = record->id();
+      accepted["status"] = jobStateName(record->snapshot().state);
+      accepted["href"] = "/api/jobs/" + record->id();
+      accepted["events"] = "/api/jobs/" + record->id() + "/events";
+      res.status = 202;
+      res.set_content(accepted.dump(), "application/json");
 
     } catch (const json::parse_error& e) {
       Logger::log(Logger::ERROR, "JSON parse error: " + std::string(e.what()));
-      json error;
-      error["error"] = "Invalid JSON format";
-      res.status = 400;
-      res.set_content(error.dump(), "application/json");
+      sendError(res, 400, "Invalid JSON format");
     } catch (const std::exception& e) {
       Logger::log(Logger::ERROR, "Server error: " + std::string(e.what()));
-      json error;
-      error["error"] = std::string("Server error: ") + e.what();
-      res.status = 500;
-      res.set_content(error.dump(), "application/json");
+      sendError(res, 500, std::string("Server error: ") + e.what());
+    }
+  });
+
+  // Job status: the latest progress while running, the response when done
+  svr.Get("/api/jobs/([0-9a-f]+)", [](const httplib::Request& req,
+                                      httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    std::shared_ptr<JobRecord> record = g_jobStore->find(req.matches[1]);
+    if (!record) {
+      sendError(res, 404, "Unknown job");
+      return;
+    }
+    // The stored documents are already serialized, so splice them in
+    JobRecord::Snapshot snapshot = record->snapshot();
+    std::string document = "{\"id\":\"" + record->id() + "\",\"status\":\"" +
+                           jobStateName(snapshot.state) + "\"";
+    if (!snapshot.progress.empty()) {
+      document += ",\"progress\":" + snapshot.progress;
+    }
+    if (!snapshot.result.empty()) {
+      document += ",\"result\":" + snapshot.result;
+    }
+    document += "}";
+    res.set_content(document, "application/json");
+  });
+
+  // Server-sent events: "progress" while solving, then "done" or "failed"
+  svr.Get("/api/jobs/([0-9a-f]+)/events", [](const httplib::Request& req,
+                                             httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    std::shared_ptr<JobRecord> record = g_jobStore->find(req.matches[1]);
+    if (!record) {
+      sendError(res, 404, "Unknown job");
+      return;
+    }
+    // Each open stream holds an HTTP thread, so their number is capped
+    if (g_openStreams.fetch_add(1) >= g_maxStreams) {
+      g_openStreams--;
+      rejectBusy(res, "Too many open event streams");
+      return;
+    }
+
+    // A reconnecting EventSource resumes after the last event it saw
+    auto lastSeq = std::make_shared<uint64_t>(0);
+    if (req.has_header("Last-Event-ID")) {
+      try {
+        *lastSeq = std::stoull(req.get_header_value("Last-Event-ID"));
+      } catch (const std::exception&) {
+      }
     }
+    res.set_header("Cache-Control", "no-cache");
+    res.set_header("X-Accel-Buffering", "no");
+    res.set_chunked_content_provider(
+        "text/event-stream",
+        [record, lastSeq](size_t, httplib::DataSink& sink) {
+          bool complete = false;
+          auto events = record->waitEvents(
+              *lastSeq, std::chrono::milliseconds(15000), complete);
+          if (events.empty() && !complete) {
+            // Keep proxies from timing out an idle stream
+            std::string ping = ": keepalive\n\n";
+            return sink.write(ping.data(), ping.size());
+          }
+          for (const auto& event : events) {
+            std::string chunk = "id: " + std::to_string(event.seq) +
+                                "\nevent: " + event.type +
+                                "\ndata: " + event.data + "\n\n";
+            if (!sink.write(chunk.data(), chunk.size()))
+              return false;
+            *lastSeq = event.seq;
+          }
+          if (complete) {
+            sink.done();
+          }
+          return true;
+        },
+        [](bool) { g_openStreams--; });
   });
 
   // Handle 404s
@@ -380,15 +1405,26 @@ int main() {
   Logger::log(Logger::INFO, "Available endpoints:");
   Logger::log(Logger::INFO, "  GET  /              - Web interface");
   Logger::log(Logger::INFO, "  GET  /api/health    - Health check");
+  Logger::log(Logger::INFO, "  GET  /api/cache     - Solution cache stats");
+  Logger::log(Logger::INFO, "  GET  /api/pool      - Solver pool load");
+  Logger::log(Logger::INFO, "  GET  /api/metrics   - Prometheus metrics");
   Logger::log(Logger::INFO, "  POST /api/optimize  - Run optimization");
+  Logger::log(Logger::INFO, "  POST /api/optimize/batch - Run many jobs");
+  Logger::log(Logger::INFO, "  POST /api/jobs      - Start a background job");
+  Logger::log(Logger::INFO, "  GET  /api/jobs/{id} - Job status and result");
+  Logger::log(Logger::INFO, "  GET  /api/jobs/{id}/events - Job progress");
   Logger::log(Logger::INFO, "==========================================");
   Logger::log(Logger::INFO, "Press Ctrl+C to stop");
 
   if (!svr.listen("0.0.0.0", 8080)) {
     Logger::log(Logger::ERROR, "Failed to start server - port may be in use");
+    g_solverPool->shutdown();
+    Logger::stop();
     return 1;
   }
 
+  g_solverPool->shutdown();
   Logger::log(Logger::INFO, "Server stopped");
+  Logger::stop();
   return 0;
 }
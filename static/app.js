@@ -137,6 +137,7 @@ document.addEventListener('alpine:init', () => {
         errorMsg: '',
         loading: false,
         results: null,
+        progress: null,
         showModal: false,
         globalColorMap: {},
         nextColorIndex: 1,
@@ -243,19 +244,19 @@ document.addEventListener('alpine:init', () => {
             };
 
             try {
-                const response = await fetch('/api/optimize', {
+                const response = await fetch('/api/jobs', {
                     method: 'POST',
                     headers: { 'Content-Type': 'application/json' },
                     body: JSON.stringify(data)
                 });
 
-                const result = await response.json();
+                const job = await response.json();
 
                 if (!response.ok) {
-                    throw new Error(result.error || 'Optimization failed');
+                    throw new Error(job.error || 'Optimization failed');
                 }
 
-                this.results = result;
+                this.results = await this.followJob(job);
 
                 // Scroll to results
                 this.$nextTick(() => {
@@ -269,6 +270,63 @@ document.addEventListener('alpine:init', () => {
                 this.showError(error.message);
             } finally {
                 this.loading = false;
+                this.progress = null;
+            }
+        },
+
+        // Show a progress report, and the plan it carries when it improved
+        showProgress(progress) {
+            this.progress = progress;
+            if (progress.response) {
+                this.results = progress.response;
+            }
+        },
+
+        // Follow a job's event stream until it finishes; resolves with the
+        // final response. Falls back to polling without EventSource.
+        followJob(job) {
+            if (!window.EventSource) {
+                return this.pollJob(job);
+            }
+            return new Promise((resolve, reject) => {
+                const source = new EventSource(job.events);
+                source.addEventListener('progress', (event) => {
+                    this.showProgress(JSON.parse(event.data));
+                });
+                source.addEventListener('done', (event) => {
+                    source.close();
+                    resolve(JSON.parse(event.data));
+                });
+                source.addEventListener('failed', (event) => {
+                    source.close();
+                    reject(new Error(JSON.parse(event.data).error || 'Optimization failed'));
+                });
+                // The browser reconnects on its own unless the server refused
+                source.onerror = () => {
+                    if (source.readyState === EventSource.CLOSED) {
+                        this.pollJob(job).then(resolve, reject);
+                    }
+                };
+            });
+        },
+
+        async pollJob(job) {
+            for (;;) {
+                const response = await fetch(job.href);
+                const status = await response.json();
+                if (!response.ok) {
+                    throw new Error(status.error || 'Optimization failed');
+                }
+                if (status.status === 'done') {
+                    return status.result;
+                }
+                if (status.status === 'failed') {
+                    throw new Error(status.result.error || 'Optimization failed');
+                }
+                if (status.progress) {
+                    this.showProgress(status.progress);
+                }
+                await new Promise((resolve) => setTimeout(resolve, 1000));
             }
         },
 
@@ -0,0 +1,159 @@
+// Greedy packer checks: First Fit and Best Fit cut exactly the demand, no
+// layout overfills its stick, and neither memory nor time grows with the
+// quantity of a length.
+//
+//   make check
+
+#include "arena.h"
+#include "heuristics.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int g_failures = 0;
+
+static void check(bool ok, const std::string& what) {
+  if (!ok) {
+    std::cerr << "FAIL: " << what << "\n";
+    g_failures++;
+  }
+}
+
+// Every layout fits on the stock with one kerf between pieces, and the
+// sticks over all layouts hold each length's demand exactly
+static void checkPacking(const Packing& packing,
+                         const std::vector<long long>& lengths,
+                         const std::vector<int>& demand, long long stockLen,
+                         long long kerf, const std::string& name) {
+  const PatternSet& layouts = packing.patterns;
+  check(packing.multiplicity.size() == layouts.size(),
+        name + ": one multiplicity per layout");
+  std::vector<long long> cut(lengths.size(), 0);
+  for (size_t p = 0; p < layouts.size(); p++) {
+    long long load = 0;
+    for (HighsInt k = layouts.start[p]; k < layouts.start[p + 1]; k++) {
+      load += static_cast<long long>(layouts.value[k]) *
+              (lengths[layouts.index[k]] + kerf);
+      cut[layouts.index[k]] +=
+          static_cast<long long>(layouts.value[k]) * packing.multiplicity[p];
+    }
+    check(load <= stockLen + kerf,
+          name + ": layout " + std::to_string(p) + " fits its stick");
+    check(packing.multiplicity[p] > 0,
+          name + ": layout " + std::to_string(p) + " is used");
+  }
+  for (size_t i = 0; i < lengths.size(); i++) {
+    check(cut[i] == demand[i],
+          name + ": length " + std::to_string(i) + " cut " +
+              std::to_string(cut[i]) + " times, expected " +
+              std::to_string(demand[i]));
+  }
+}
+
+static void testRandomDemands() {
+  std::mt19937 rng(4242);
+  for (int round = 0; round < 200; round++) {
+    int numLengths = 1 + static_cast<int>(rng() % 12);
+    long long stockLen = 2000 + static_cast<long long>(rng() % 8000);
+    long long kerf = static_cast<long long>(rng() % 9);
+    std::vector<long long> lengths;
+    long long length = stockLen;
+    for (int i = 0; i < numLengths; i++) {
+      length -= 1 + static_cast<long long>(rng() % (stockLen / 8));
+      if (length < 1)
+        break;
+      lengths.push_back(length);
+    }
+    if (lengths.empty())
+      continue;
+    std::vector<int> demand;
+    for (size_t i = 0; i < lengths.size(); i++) {
+      demand.push_back(1 + static_cast<int>(rng() % (round % 4 ? 20 : 3000)));
+    }
+    std::string name = "round " + std::to_string(round);
+    checkPacking(firstFitDecreasing(lengths, demand, stockLen, kerf), lengths,
+                 demand, stockLen, kerf, name + " first fit");
+    checkPacking(bestFitDecreasing(lengths, demand, stockLen, kerf), lengths,
+                 demand, stockLen, kerf, name + " best fit");
+  }
+}
+
+// Run a packer inside a request-wide scope on a thread of its own, as a
+// solver thread does, and return the block its arena keeps afterwards,
+// which has grown to what the call took
+template <typename Packer>
+static size_t arenaBytes(Packer packer) {
+  size_t bytes = 0;
+  std::thread worker([&] {
+    size_t before = scratchStats().reservedBytes;
+    {
+      ScratchScope request;
+      packer();
+    }
+    bytes = scratchStats().reservedBytes - before;
+  });
+  worker.join();
+  return bytes;
+}
+
+// Short pieces, so 5M of them fill only about 2,000 sticks: the arena should
+// grow with the sticks, not with the pieces
+static void testLargeQuantityArena() {
+  const std::vector<long long> lengths = {10};
+  const std::vector<int> many = {5000000};
+  const size_t limit = 4 << 20;
+  size_t ffd = arenaBytes(
+      [&] { firstFitDecreasing(lengths, many, 24000, 0); });
+  check(ffd <= limit, "first fit over 5M pieces keeps " +
+                          std::to_string(ffd) + " arena bytes");
+  size_t bfd = arenaBytes(
+      [&] { bestFitDecreasing(lengths, many, 24000, 0); });
+  check(bfd <= limit, "best fit over 5M pieces keeps " +
+                          std::to_string(bfd) + " arena bytes");
+}
+
+// Long pieces, about 200,000 sticks of one layout, and the largest demand a
+// request may hold: each length is placed in bulk, so neither the arena nor
+// the time grows with the quantity
+static void testBulkPlacement() {
+  const std::vector<long long> lengths = {1000};
+  const std::vector<int> many = {5000000};
+  const size_t limit = 4 << 20;
+  size_t ffd = arenaBytes(
+      [&] { firstFitDecreasing(lengths, many, 24000, 8); });
+  check(ffd <= limit, "first fit over 200k sticks keeps " +
+                          std::to_string(ffd) + " arena bytes");
+  size_t bfd = arenaBytes(
+      [&] { bestFitDecreasing(lengths, many, 24000, 8); });
+  check(bfd <= limit, "best fit over 200k sticks keeps " +
+                          std::to_string(bfd) + " arena bytes");
+
+  const std::vector<long long> mixed = {9000, 4000, 1000, 10};
+  const std::vector<int> huge = {500000000, 500000000, 500000000, 600000000};
+  auto start = std::chrono::steady_clock::now();
+  Packing first = firstFitDecreasing(mixed, huge, 24000, 8);
+  Packing best = bestFitDecreasing(mixed, huge, 24000, 8);
+  std::chrono::duration<double, std::milli> taken =
+      std::chrono::steady_clock::now() - start;
+  checkPacking(first, mixed, huge, 24000, 8, "2.1G pieces first fit");
+  checkPacking(best, mixed, huge, 24000, 8, "2.1G pieces best fit");
+  check(first.patterns.size() < 20 && best.patterns.size() < 20,
+        "2.1G pieces pack into a handful of layouts");
+  check(taken.count() < 1000.0, "2.1G pieces pack at once");
+}
+
+int main() {
+  testRandomDemands();
+  testLargeQuantityArena();
+  testBulkPlacement();
+  if (g_failures > 0) {
+    std::cerr << g_failures << " check(s) failed\n";
+    return 1;
+  }
+  std::cout << "heuristics tests passed\n";
+  return 0;
+}
@@ -0,0 +1,183 @@
+// Per-stick output checks: expanding a plan into sticks hands every request
+// entry exactly its quantity of pieces, of its own length, whatever order
+// the request lists its cuts in, and the written sticks name the entries of
+// the request's cut list.
+//
+//   make check
+
+#include "json_writer.h"
+#include "output.h"
+#include "report.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+static int g_failures = 0;
+
+static void check(bool ok, const std::string& what) {
+  if (!ok) {
+    std::cerr << "FAIL: " << what << "\n";
+    g_failures++;
+  }
+}
+
+// Random demands over a few lengths, several entries sharing some of them
+// as a cut list with the same part in two lines does
+static std::vector<Demand> makeDemands(std::mt19937& rng) {
+  std::vector<Demand> demands;
+  int distinct = 1 + static_cast<int>(rng() % 6);
+  int entries = distinct + static_cast<int>(rng() % 4);
+  for (int e = 0; e < entries; e++) {
+    int i = e < distinct ? e : static_cast<int>(rng() % distinct);
+    demands.push_back(Demand(12.0 + 8.25 * i,
+                             1 + static_cast<int>(rng() % 40),
+                             "part " + std::to_string(e)));
+  }
+  std::shuffle(demands.begin(), demands.end(), rng);
+  return demands;
+}
+
+// A solution cutting exactly the demand in random runs, as the solver
+// returns it: distinct lengths longest first, and the request's id runs
+static Solution makeSolution(std::mt19937& rng,
+                             const std::vector<Demand>& demands) {
+  Solution solution;
+  solution.scale = unitScale(LengthUnits::Inches);
+  std::map<long long, int, std::greater<long long>> pieces;
+  for (const auto& demand : demands) {
+    pieces[static_cast<long long>(demand.length * solution.scale)] +=
+        demand.quantity;
+  }
+  std::vector<int> left;
+  for (const auto& [len, quantity] : pieces) {
+    solution.lengths.push_back(len);
+    left.push_back(quantity);
+  }
+  solution.cut_ids = demandIds(solution, demands);
+
+  for (size_t i = 0; i < left.size(); i++) {
+    while (left[i] > 0) {
+      StickRun run;
+      run.stock_len = 240.0;
+      int quantity = 1 + static_cast<int>(rng() % 3);
+      run.count = 1 + static_cast<int>(rng() % 5);
+      if (quantity * run.count > left[i]) {
+        quantity = 1;
+        run.count = left[i];
+      }
+      run.pieces.push_back({static_cast<int>(i), quantity});
+      left[i] -= quantity * run.count;
+      // Share the stick with a shorter length when one fits
+      for (size_t j = i + 1; j < left.size(); j++) {
+        if (left[j] >= run.count) {
+          run.pieces.push_back({static_cast<int>(j), 1});
+          left[j] -= run.count;
+          break;
+        }
+      }
+      solution.runs.push_back(run);
+      solution.num_sticks += run.count;
+    }
+  }
+  std::shuffle(solution.runs.begin(), solution.runs.end(), rng);
+  return solution;
+}
+
+// The expanded sticks hold each demand's quantity under its index, every
+// piece of the demand's length
+static void checkIds(const std::vector<Stick>& sticks, const Solution& solution,
+                     const std::vector<Demand>& demands,
+                     const std::string& name) {
+  check(sticks.size() == static_cast<size_t>(solution.num_sticks),
+        name + ": one stick per stick of the runs");
+  std::vector<long long> pieces(demands.size(), 0);
+  bool inRange = true;
+  bool sameLength = true;
+  for (const auto& stick : sticks) {
+    for (const auto& cut : stick.cuts) {
+      if (cut.id < 0 || static_cast<size_t>(cut.id) >= demands.size()) {
+        inRange = false;
+        continue;
+      }
+      pieces[cut.id]++;
+      sameLength = sameLength && cut.length == demands[cut.id].length;
+    }
+  }
+  check(inRange, name + ": every id names a request entry");
+  check(sameLength, name + ": every piece has its entry's length");
+  for (size_t k = 0; k < demands.size(); k++) {
+    check(pieces[k] == demands[k].quantity,
+          name + ": entry " + std::to_string(k) + " has " +
+              std::to_string(pieces[k]) + " pieces, expected " +
+              std::to_string(demands[k].quantity));
+  }
+}
+
+static void testExpandedIds() {
+  std::mt19937 rng(1601);
+  for (int round = 0; round < 100; round++) {
+    std::vector<Demand> demands = makeDemands(rng);
+    Solution solution = makeSolution(rng, demands);
+    std::string name = "round " + std::to_string(round);
+    checkIds(expandSticks(solution), solution, demands, name);
+
+    // The same job listed in another order, served the cached solution
+    std::vector<Demand> reordered = demands;
+    std::shuffle(reordered.begin(), reordered.end(), rng);
+    checkIds(expandSticks(solution, demandIds(solution, reordered)), solution,
+             reordered, name + " reordered");
+  }
+}
+
+// Written sticks give each cut the cut list position of its entry, which
+// skips no line even when an earlier one had no pieces
+static void testWrittenEntries() {
+  std::mt19937 rng(16);
+  std::vector<Demand> demands = makeDemands(rng);
+  Solution solution = makeSolution(rng, demands);
+  std::vector<int> entries(demands.size());
+  std::iota(entries.begin(), entries.end(), 1);
+
+  std::string text;
+  JsonWriter out(text);
+  writeSticks(out, solution, solution.cut_ids, entries);
+  // The writer's own compact output: count the sticks and the entries
+  auto count = [&text](const std::string& what) {
+    size_t n = 0;
+    for (size_t at = text.find(what); at != std::string::npos;
+         at = text.find(what, at + 1)) {
+      n++;
+    }
+    return n;
+  };
+  check(count("\"stock_len\":240.0,") ==
+            static_cast<size_t>(solution.num_sticks),
+        "one written stick per stick, with its stock length");
+  std::map<int, int> pieces;
+  for (size_t at = text.find("\"entry\":"); at != std::string::npos;
+       at = text.find("\"entry\":", at + 1)) {
+    pieces[std::stoi(text.substr(at + 8))]++;
+  }
+  for (size_t k = 0; k < demands.size(); k++) {
+    check(pieces[entries[k]] == demands[k].quantity,
+          "cut list line " + std::to_string(entries[k]) + " has " +
+              std::to_string(pieces[entries[k]]) + " written pieces");
+  }
+  check(pieces.count(0) == 0, "the skipped line has no pieces");
+}
+
+int main() {
+  testExpandedIds();
+  testWrittenEntries();
+  if (g_failures > 0) {
+    std::cerr << g_failures << " check(s) failed\n";
+    return 1;
+  }
+  std::cout << "output tests passed\n";
+  return 0;
+}
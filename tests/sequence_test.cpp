@@ -0,0 +1,174 @@
+// Saw planner checks: every plan cuts each pattern's sticks exactly once
+// and sets each saw up for a pattern at most once, the search never ends up
+// worse than its greedy start, and it stops early when it has nothing left
+// to try.
+//
+//   make check
+
+#include "output.h"
+#include "sequence.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+static int g_failures = 0;
+
+static void check(bool ok, const std::string& what) {
+  if (!ok) {
+    std::cerr << "FAIL: " << what << "\n";
+    g_failures++;
+  }
+}
+
+// A solution of `patterns` random runs over `lengths` distinct lengths, as
+// planSaws reads it; stock and waste do not enter the plan
+static Solution makeSolution(std::mt19937& rng, int lengths, int patterns) {
+  Solution solution;
+  for (int i = 0; i < lengths; i++) {
+    solution.lengths.push_back(1000 - 10 * i);
+  }
+  for (int p = 0; p < patterns; p++) {
+    StickRun run;
+    int distinct = 1 + static_cast<int>(rng() % 4);
+    for (int k = 0; k < distinct; k++) {
+      int i = static_cast<int>(rng() % lengths);
+      bool have = false;
+      for (const auto& piece : run.pieces) {
+        have = have || piece.first == i;
+      }
+      if (!have)
+        run.pieces.push_back({i, 1 + static_cast<int>(rng() % 3)});
+    }
+    std::sort(run.pieces.begin(), run.pieces.end());
+    run.count = 1 + static_cast<int>(rng() % 12);
+    run.stock_len = 240.0;
+    solution.runs.push_back(run);
+    solution.num_sticks += run.count;
+  }
+  return solution;
+}
+
+// Open stacks over the limit, makespan and total saw time, the ranking
+// planSaws uses
+struct Rank {
+  int excess{0};
+  double makespan{0.0};
+  double total{0.0};
+};
+
+static Rank rank(const SawPlan& plan, const SawSettings& settings) {
+  Rank r;
+  for (const auto& saw : plan.saws) {
+    if (settings.maxOpenStacks > 0)
+      r.excess += std::max(0, saw.openStacks - settings.maxOpenStacks);
+    r.makespan = std::max(r.makespan, saw.seconds);
+    r.total += saw.seconds;
+  }
+  return r;
+}
+
+static bool noWorse(const Rank& a, const Rank& b) {
+  if (a.excess != b.excess)
+    return a.excess < b.excess;
+  if (a.makespan > b.makespan + 1e-6)
+    return false;
+  return a.makespan < b.makespan - 1e-6 || a.total <= b.total + 1e-6;
+}
+
+// Every pattern's sticks are on the saws exactly once, in batches of at
+// least one stick, and no saw has two batches of one pattern
+static void checkPlan(const Solution& solution, const SawSettings& settings,
+                      const SawPlan& plan, const std::string& name) {
+  std::vector<RunGroup> groups = groupRuns(solution);
+  check(plan.saws.size() == static_cast<size_t>(settings.saws),
+        name + ": one schedule per saw");
+  std::vector<long long> sticks(groups.size(), 0);
+  for (size_t s = 0; s < plan.saws.size(); s++) {
+    std::map<size_t, int> seen;
+    for (const auto& batch : plan.saws[s].batches) {
+      check(batch.pattern < groups.size(), name + ": pattern in range");
+      check(batch.sticks > 0, name + ": batch has sticks");
+      check(seen[batch.pattern]++ == 0,
+            name + ": saw " + std::to_string(s) + " sets up for pattern " +
+                std::to_string(batch.pattern) + " once");
+      if (batch.pattern < groups.size())
+        sticks[batch.pattern] += batch.sticks;
+    }
+  }
+  for (size_t g = 0; g < groups.size(); g++) {
+    check(sticks[g] == groups[g].count,
+          name + ": pattern " + std::to_string(g) + " has " +
+              std::to_string(sticks[g]) + " sticks, expected " +
+              std::to_string(groups[g].count));
+  }
+}
+
+static void testConservationAndNeverWorse() {
+  std::mt19937 rng(20240611);
+  for (int round = 0; round < 40; round++) {
+    Solution solution =
+        makeSolution(rng, 4 + round % 9, 1 + static_cast<int>(rng() % 30));
+    SawSettings settings;
+    settings.saws = 1 + round % 4;
+    settings.maxOpenStacks = round % 3 == 0 ? 3 : 0;
+    settings.threads = 1 + round % 2;
+    std::string name = "round " + std::to_string(round);
+
+    // No budget leaves the greedy start as it is
+    settings.timeBudgetMs = 0.0;
+    SawPlan greedy = planSaws(solution, settings);
+    checkPlan(solution, settings, greedy, name + " greedy");
+
+    settings.timeBudgetMs = 20.0;
+    SawPlan searched = planSaws(solution, settings);
+    checkPlan(solution, settings, searched, name + " searched");
+    check(noWorse(rank(searched, settings), rank(greedy, settings)),
+          name + ": search is no worse than the greedy start");
+  }
+}
+
+static void testNoSaws() {
+  std::mt19937 rng(7);
+  SawSettings settings;
+  SawPlan plan = planSaws(makeSolution(rng, 5, 5), settings);
+  check(plan.saws.empty(), "no saws gives an empty plan");
+}
+
+// A plan the search cannot change, or stops improving, comes back long
+// before a generous budget runs out
+static void testStopsEarly() {
+  std::mt19937 rng(99);
+  SawSettings settings;
+  settings.timeBudgetMs = 10000.0;
+
+  settings.saws = 1;
+  auto start = std::chrono::steady_clock::now();
+  planSaws(makeSolution(rng, 3, 1), settings);
+  std::chrono::duration<double, std::milli> fixed =
+      std::chrono::steady_clock::now() - start;
+  check(fixed.count() < 1000.0, "one pattern on one saw returns at once");
+
+  settings.saws = 2;
+  start = std::chrono::steady_clock::now();
+  planSaws(makeSolution(rng, 6, 8), settings);
+  std::chrono::duration<double, std::milli> stalled =
+      std::chrono::steady_clock::now() - start;
+  check(stalled.count() < 5000.0, "a stalled search stops before its budget");
+}
+
+int main() {
+  testConservationAndNeverWorse();
+  testNoSaws();
+  testStopsEarly();
+  if (g_failures > 0) {
+    std::cerr << g_failures << " check(s) failed\n";
+    return 1;
+  }
+  std::cout << "sequence tests passed\n";
+  return 0;
+}